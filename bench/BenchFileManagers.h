@@ -0,0 +1,47 @@
+#pragma once
+
+#include "pebble/core/IFileManager.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace pebble {
+    namespace bench {
+
+        // File manager for benches that time the BufferPool, not the disk: every page exists and
+        // reads back blank, writes are dropped and allocation hands out fresh IDs from 2. Each read
+        // call sleeps readMicros and each write call writeMicros, like a device; 0 costs nothing.
+        class BenchFileManager : public core::IFileManager {
+        public:
+            explicit BenchFileManager(unsigned readMicros = 0, unsigned writeMicros = 0)
+                : m_ReadCost(readMicros), m_WriteCost(writeMicros) {}
+
+            void readPage(uint32_t pageID, core::Page& page) override {
+                delay(m_ReadCost);
+                page.clear();
+                page.setPageID(pageID);
+            }
+            void writePage(const core::Page&) override { delay(m_WriteCost); }
+            void writePages(std::vector<const core::Page*>) override { delay(m_WriteCost); }
+            uint32_t allocatePage() override { return allocatePages(1, 0); }
+            uint32_t allocatePages(uint32_t count, uint32_t) override { return m_Next.fetch_add(count); }
+            void freePage(uint32_t) override {}
+            void flush() override {}
+            bool pageExists(uint32_t) const override { return true; }
+            void printFreeList() override {}
+
+        private:
+            static void delay(std::chrono::microseconds cost) {
+                if (cost.count() > 0)
+                    std::this_thread::sleep_for(cost);
+            }
+
+            std::chrono::microseconds m_ReadCost;
+            std::chrono::microseconds m_WriteCost;
+            std::atomic<uint32_t> m_Next{ 2 };      // page 0 is the meta page, page 1 the catalog
+        };
+
+    }
+}
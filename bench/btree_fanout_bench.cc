@@ -0,0 +1,81 @@
+// B+ tree height and lookup throughput by order: the old default of 4 keys per node against
+// DEFAULT_ORDER, which fills a page. Each tree is built by inserting keys in ascending order through
+// a pool of `frames`, then serves random lookups of present keys. Reported per tree: node pages,
+// file size, depth (page fetches per lookup) and lookups per second. An order 4 tree of 10M keys
+// takes tens of GiB, so order 4 runs on `smallKeys` only and the page-filling order on both.
+//
+// Usage: btree_fanout_bench [keys] [smallKeys] [frames] [lookups] [backend] [path]
+
+#include "pebble/core/BPlusTree.h"
+#include "pebble/core/BufferPool.h"
+#include "pebble/core/FileManagerFactory.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+using namespace pebble::core;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    void run(FileManagerType backend, const std::string& path, int order, int keys, size_t frames, size_t lookups) {
+        std::remove(path.c_str());
+        auto fm = createFileManager(backend, path);
+        BufferPool pool(*fm, frames);
+        BPlusTree tree(pool, order);
+
+        auto t0 = Clock::now();
+        for (int key = 0; key < keys; ++key)
+            tree.insert(key, static_cast<uint64_t>(key));
+        double buildSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+        size_t nodes = tree.nodePages().size();
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> pick(0, keys - 1);
+        BufferPoolStats before = pool.stats();
+        t0 = Clock::now();
+        for (size_t i = 0; i < lookups; ++i) {
+            if (!tree.search(pick(rng))) {
+                std::fprintf(stderr, "Key missing at order %d\n", order);
+                std::exit(1);
+            }
+        }
+        double lookupSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+        BufferPoolStats after = pool.stats();
+        uint64_t fetches = after.fetches - before.fetches;
+        double hitRate = fetches ? static_cast<double>(after.hits - before.hits) / fetches : 0.0;
+
+        std::printf("%6d %10d %10zu %9zu %7.2f %9.1f %12.0f %9.1f%%\n", order, keys, nodes, nodes * PAGE_SIZE >> 20,
+                    static_cast<double>(fetches) / lookups, buildSeconds, lookups / lookupSeconds, hitRate * 100);
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    int keys = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    int smallKeys = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    size_t frames = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 65536;
+    size_t lookups = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1000000;
+    std::string backendName = argc > 5 ? argv[5] : "posix";
+    auto parsed = parseFileManagerType(backendName);
+    if (!parsed) {
+        std::fprintf(stderr, "Unknown file manager backend: %s\n", backendName.c_str());
+        return 1;
+    }
+    std::string path = argc > 6 ? argv[6] : "btree_fanout_bench.db";
+
+    std::printf("%zu frames (%zu MiB), %zu random lookups, %s backend\n", frames, frames * PAGE_SIZE >> 20, lookups,
+                backendName.c_str());
+    std::printf("%6s %10s %10s %9s %7s %9s %12s %10s\n", "order", "keys", "nodes", "MiB", "depth", "build s",
+                "lookups/s", "hit rate");
+    run(*parsed, path, 4, smallKeys, frames, lookups);
+    run(*parsed, path, DEFAULT_ORDER, smallKeys, frames, lookups);
+    run(*parsed, path, DEFAULT_ORDER, keys, frames, lookups);
+    std::remove(path.c_str());
+    return 0;
+}
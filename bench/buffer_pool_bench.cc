@@ -0,0 +1,118 @@
+// BufferPool fetchPage + unpinPage for growing pool sizes: hits on resident pages, and misses
+// from cycling through twice as many pages as there are frames (every fetch evicts). Updates of
+// resident pages compare fetchPage + markDirty + unpinPage with a WritePageGuard.
+// Pages come from an in-memory file manager, so only the pool's own bookkeeping is timed;
+// neither cost should grow with the number of frames.
+//
+// Usage: buffer_pool_bench [maxFrames] [accesses]
+
+#include "pebble/core/BufferPool.h"
+
+#include "BenchFileManagers.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace pebble::core;
+using pebble::bench::BenchFileManager;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double hitNs(size_t frames, size_t hits) {
+        BenchFileManager fm;
+        BufferPool pool(fm, frames);
+
+        // Pages start at 2: page 0 is the meta page, page 1 the catalog
+        for (uint32_t i = 0; i < frames; ++i) {
+            pool.fetchPage(i + 2);
+            pool.unpinPage(i + 2);
+        }
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> pick(2, static_cast<uint32_t>(frames + 1));
+        std::vector<uint32_t> order(hits);
+        for (auto& id : order) id = pick(rng);
+
+        auto t0 = Clock::now();
+        for (uint32_t id : order) {
+            pool.fetchPage(id);
+            pool.unpinPage(id);
+        }
+        auto t1 = Clock::now();
+
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / hits;
+    }
+
+    double updateNs(size_t frames, size_t updates, bool guarded) {
+        BenchFileManager fm;
+        BufferPool pool(fm, frames);
+
+        for (uint32_t i = 0; i < frames; ++i) {
+            pool.fetchPage(i + 2);
+            pool.unpinPage(i + 2);
+        }
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> pick(2, static_cast<uint32_t>(frames + 1));
+        std::vector<uint32_t> order(updates);
+        for (auto& id : order) id = pick(rng);
+
+        auto t0 = Clock::now();
+        for (uint32_t id : order) {
+            if (guarded) {
+                WritePageGuard guard = pool.fetchPageWrite(id);
+                guard.page().payload()[0]++;
+            }
+            else {
+                pool.fetchPage(id).payload()[0]++;
+                pool.markDirty(id);
+                pool.unpinPage(id);
+            }
+        }
+        auto t1 = Clock::now();
+
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / updates;
+    }
+
+    double missNs(size_t frames, size_t misses) {
+        BenchFileManager fm;
+        BufferPool pool(fm, frames);
+
+        uint32_t pages = static_cast<uint32_t>(2 * frames);
+        for (uint32_t i = 0; i < frames; ++i) {
+            pool.fetchPage(i + 2);
+            pool.unpinPage(i + 2);
+        }
+
+        auto t0 = Clock::now();
+        uint32_t next = static_cast<uint32_t>(frames);
+        for (size_t i = 0; i < misses; ++i) {
+            uint32_t id = next + 2;
+            pool.fetchPage(id);
+            pool.unpinPage(id);
+            next = next + 1 == pages ? 0 : next + 1;
+        }
+        auto t1 = Clock::now();
+
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / misses;
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t maxFrames = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t hits = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+
+    std::printf("%10s %14s %14s %14s %14s\n", "frames", "ns/hit", "ns/miss", "ns/update", "ns/guarded");
+    for (size_t frames = 100; frames <= maxFrames; frames *= 10)
+        std::printf("%10zu %14.1f %14.1f %14.1f %14.1f\n", frames, hitNs(frames, hits), missNs(frames, hits),
+                    updateNs(frames, hits, false), updateNs(frames, hits, true));
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Foreground fetch latency with and without the BufferPool background cleaner. One thread
+// updates random pages of a working set twice the pool (write guard on every other fetch), so
+// about half the evictions would find a dirty victim. The file manager keeps pages in memory but
+// makes each read sleep like a device read, and each write call like a device write plus sync,
+// so a fetch that has to write back shows up in the tail.
+//
+// Usage: buffer_pool_cleaner_bench [frames] [fetches] [readMicros] [writeMicros]
+
+#include "pebble/core/BufferPool.h"
+
+#include "BenchFileManagers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace pebble::core;
+using pebble::bench::BenchFileManager;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    void run(const char* label, bool cleaner, size_t frames, size_t fetches, unsigned readMicros, unsigned writeMicros) {
+        BenchFileManager fm(readMicros, writeMicros);
+        BufferPool pool(fm, frames, ReplacementPolicyType::LRU, 1);
+        for (uint32_t i = 0; i < frames; ++i)
+            pool.fetchPageRead(i + 2);
+        if (cleaner)
+            pool.startCleaner();
+
+        // Pages start at 2: page 0 is the meta page, page 1 the catalog
+        uint32_t pages = static_cast<uint32_t>(2 * frames);
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<uint32_t> pick(2, pages + 1);
+
+        std::vector<double> micros;
+        micros.reserve(fetches);
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < fetches; ++i) {
+            uint32_t id = pick(rng);
+            auto start = Clock::now();
+            if (i & 1) {
+                WritePageGuard guard = pool.fetchPageWrite(id);
+                guard.page();
+            }
+            else {
+                ReadPageGuard guard = pool.fetchPageRead(id);
+            }
+            micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+        BufferPoolStats stats = pool.stats();
+        std::sort(micros.begin(), micros.end());
+        auto pct = [&](double p) { return micros[std::min(micros.size() - 1, static_cast<size_t>(p * micros.size()))]; };
+        std::printf("%-10s %10.0f %8.2f %8.2f %9.1f %9.1f %9llu %10llu %11.0f\n", label, fetches / seconds,
+                    pct(0.50), pct(0.99), pct(0.999), micros.back(),
+                    static_cast<unsigned long long>(stats.stalledEvictions),
+                    static_cast<unsigned long long>(stats.cleanerPagesWritten), stats.cleanerPagesPerSecond());
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t frames = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    size_t fetches = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50000;
+    unsigned readMicros = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 20;
+    unsigned writeMicros = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 200;
+
+    std::printf("%zu frames, %zu fetches, %u us per read, %u us per write call\n", frames, fetches, readMicros, writeMicros);
+    std::printf("%-10s %10s %8s %8s %9s %9s %9s %10s %11s\n", "", "fetches/s", "p50 us", "p99 us", "p99.9 us",
+                "max us", "stalls", "cleaned", "cleaned/s");
+    run("no cleaner", false, frames, fetches, readMicros, writeMicros);
+    run("cleaner", true, frames, fetches, readMicros, writeMicros);
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Fetch latency percentiles under a mixed hit/miss multi-threaded workload. Each thread mostly
+// fetches pages of a hot set that stays resident, and sometimes a page of a cold range far larger
+// than the pool, which misses; a quarter of the fetches take a write guard, so some evictions
+// write back. The file manager keeps nothing but sleeps like a device on every read and write
+// call. The pool has a single shard, so every thread contends for the same shard latch: hits
+// should not queue behind another thread's disk I/O.
+//
+// Usage: buffer_pool_latency_bench [threads] [frames] [fetchesPerThread] [missPercent] [ioMicros]
+
+#include "pebble/core/BufferPool.h"
+
+#include "BenchFileManagers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace pebble::core;
+using pebble::bench::BenchFileManager;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Latencies {
+        std::vector<double> hits;       // microseconds
+        std::vector<double> misses;
+    };
+
+    // v sorted
+    double percentile(const std::vector<double>& v, double p) {
+        if (v.empty())
+            return 0.0;
+        return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    unsigned threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+    size_t fetches = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 20000;
+    unsigned missPercent = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 5;
+    unsigned ioMicros = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 100;
+
+    BenchFileManager fm(ioMicros, ioMicros);
+    BufferPool pool(fm, frames, ReplacementPolicyType::LRU, 1);
+
+    // Pages start at 2: page 0 is the meta page, page 1 the catalog. The hot set is half the
+    // pool, the cold range starts after it.
+    uint32_t hotPages = static_cast<uint32_t>(frames / 2);
+    uint32_t coldFirst = 2 + hotPages;
+    for (uint32_t i = 0; i < hotPages; ++i)
+        pool.fetchPageRead(2 + i);
+
+    std::vector<Latencies> results(threads);
+    auto worker = [&](unsigned t) {
+        std::mt19937 rng(t + 1);
+        std::uniform_int_distribution<uint32_t> hot(2, coldFirst - 1);
+        std::uniform_int_distribution<uint32_t> cold(coldFirst, coldFirst + 1000000);
+        std::uniform_int_distribution<unsigned> percent(0, 99);
+        Latencies& out = results[t];
+        out.hits.reserve(fetches);
+
+        for (size_t i = 0; i < fetches; ++i) {
+            bool miss = percent(rng) < missPercent;
+            uint32_t id = miss ? cold(rng) : hot(rng);
+
+            auto start = Clock::now();
+            if ((i & 3) == 0) {
+                WritePageGuard guard = pool.fetchPageWrite(id);
+                guard.page();
+            }
+            else {
+                ReadPageGuard guard = pool.fetchPageRead(id);
+            }
+            double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            (miss ? out.misses : out.hits).push_back(micros);
+        }
+    };
+
+    auto t0 = Clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back(worker, t);
+    for (auto& w : workers)
+        w.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    Latencies all;
+    for (Latencies& r : results) {
+        all.hits.insert(all.hits.end(), r.hits.begin(), r.hits.end());
+        all.misses.insert(all.misses.end(), r.misses.begin(), r.misses.end());
+    }
+
+    std::printf("%u threads, %zu frames, %u%% misses, %u us per I/O: %.0f fetches/s\n", threads, frames, missPercent,
+                ioMicros, threads * fetches / seconds);
+    std::printf("%-6s %9s %9s %9s %9s %9s\n", "", "count", "p50 us", "p99 us", "p99.9 us", "max us");
+    for (auto [name, v] : { std::pair{ "hits", &all.hits }, std::pair{ "misses", &all.misses } }) {
+        std::sort(v->begin(), v->end());
+        std::printf("%-6s %9zu %9.1f %9.1f %9.1f %9.1f\n", name, v->size(), percentile(*v, 0.50), percentile(*v, 0.99),
+                    percentile(*v, 0.999), v->empty() ? 0.0 : v->back());
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Multi-threaded BufferPool fetch throughput: every thread runs fetchPage + markDirty (1 in 8)
+// + unpinPage on random pages of a working set 1.25x the pool, so most fetches hit and some
+// evict. Run with one shard (the old single pool latch) and with the sharded pool, for 1..maxThreads
+// threads. Pages come from an in-memory file manager, so only the pool's own latching is timed.
+//
+// Usage: buffer_pool_mt_bench [maxThreads] [frames] [opsPerThread] [shards]
+
+#include "pebble/core/BufferPool.h"
+
+#include "BenchFileManagers.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace pebble::core;
+using pebble::bench::BenchFileManager;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Million fetches per second over all threads
+    double throughput(size_t frames, size_t shards, unsigned threads, size_t ops) {
+        BenchFileManager fm;
+        BufferPool pool(fm, frames, ReplacementPolicyType::LRU, shards);
+
+        // Pages start at 2: page 0 is the meta page, page 1 the catalog
+        uint32_t pages = static_cast<uint32_t>(frames + frames / 4);
+        for (uint32_t i = 0; i < frames; ++i) {
+            pool.fetchPage(i + 2);
+            pool.unpinPage(i + 2);
+        }
+
+        auto worker = [&](unsigned seed) {
+            std::mt19937 rng(seed);
+            std::uniform_int_distribution<uint32_t> pick(2, pages + 1);
+            for (size_t i = 0; i < ops; ++i) {
+                uint32_t id = pick(rng);
+                pool.fetchPage(id);
+                if ((i & 7) == 0)
+                    pool.markDirty(id);
+                pool.unpinPage(id);
+            }
+        };
+
+        auto t0 = Clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+            workers.emplace_back(worker, t + 1);
+        for (auto& w : workers)
+            w.join();
+        auto t1 = Clock::now();
+
+        return threads * ops / std::chrono::duration<double, std::micro>(t1 - t0).count();
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    unsigned maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16384;
+    size_t ops = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 200000;
+    size_t shards = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 64;
+
+    BenchFileManager probe;
+    size_t sharded = BufferPool(probe, frames, ReplacementPolicyType::LRU, shards).shardCount();
+
+    std::printf("%u hardware threads, %zu frames\n", std::thread::hardware_concurrency(), frames);
+    char label[32];
+    std::snprintf(label, sizeof(label), "%zu shards Mops/s", sharded);
+    std::printf("%8s %16s %18s\n", "threads", "1 shard Mops/s", label);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+        std::printf("%8u %16.2f %18.2f\n", threads, throughput(frames, 1, threads, ops), throughput(frames, shards, threads, ops));
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Online resize of a BufferPool under load. Worker threads fetch random pages of a range twice
+// the large pool size, a quarter under write guards, while the main thread shrinks the pool to a
+// quarter and grows it back. Reported per phase: how long resize() took, the process RSS after it,
+// and the fetch latency percentiles of the workers during it, so a shrink that stalls fetches
+// shows in the tail. The file manager keeps nothing but sleeps like a device on every call.
+//
+// Usage: buffer_pool_resize_bench [threads] [frames] [ioMicros]
+
+#include "pebble/core/BufferPool.h"
+
+#include "BenchFileManagers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace pebble::core;
+using pebble::bench::BenchFileManager;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    size_t residentMiB() {
+        std::ifstream statm("/proc/self/statm");
+        size_t size = 0, resident = 0;
+        statm >> size >> resident;
+        return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE)) >> 20;
+    }
+
+    // v sorted
+    double percentile(const std::vector<double>& v, double p) {
+        if (v.empty())
+            return 0.0;
+        return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    unsigned threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 65536;
+    unsigned ioMicros = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 20;
+
+    BenchFileManager fm(ioMicros, ioMicros);
+    BufferPool pool(fm, frames, ReplacementPolicyType::LRU, 0, HugePageMode::NONE, frames);
+
+    // Fill the pool, then the workers run until the last phase is over
+    uint32_t pages = static_cast<uint32_t>(frames * 2);
+    for (uint32_t i = 0; i < frames; ++i)
+        pool.fetchPageWrite(2 + i).page();
+
+    std::atomic<bool> stop{ false };
+    std::mutex latencyMutex;
+    std::vector<double> latencies;      // microseconds, of the current phase
+    auto worker = [&](unsigned t) {
+        std::mt19937 rng(t + 1);
+        std::uniform_int_distribution<uint32_t> pick(2, pages + 1);
+        std::vector<double> mine;
+        for (size_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+            auto start = Clock::now();
+            if ((i & 3) == 0)
+                pool.fetchPageWrite(pick(rng)).page();
+            else
+                pool.fetchPageRead(pick(rng));
+            mine.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            if (mine.size() == 256) {
+                std::lock_guard<std::mutex> lock(latencyMutex);
+                latencies.insert(latencies.end(), mine.begin(), mine.end());
+                mine.clear();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back(worker, t);
+
+    std::printf("%u threads, %zu frames (%zu MiB), %u us per I/O\n", threads, frames, frames * PAGE_SIZE >> 20,
+                ioMicros);
+    std::printf("%-16s %10s %9s %10s %9s %9s %9s\n", "", "resize ms", "RSS MiB", "fetches", "p50 us", "p99 us",
+                "max us");
+    auto phase = [&](const char* name, size_t target) {
+        {
+            std::lock_guard<std::mutex> lock(latencyMutex);
+            latencies.clear();
+        }
+        auto t0 = Clock::now();
+        if (target)
+            pool.resize(target);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        std::vector<double> v;
+        {
+            std::lock_guard<std::mutex> lock(latencyMutex);
+            v.swap(latencies);
+        }
+        std::sort(v.begin(), v.end());
+        std::printf("%-16s %10.1f %9zu %10zu %9.1f %9.1f %9.1f\n", name, ms, residentMiB(), v.size(),
+                    percentile(v, 0.50), percentile(v, 0.99), v.empty() ? 0.0 : v.back());
+    };
+
+    phase("steady", 0);
+    phase("shrink to 1/4", frames / 4);
+    phase("small", 0);
+    phase("grow back", frames);
+    phase("large", 0);
+
+    stop = true;
+    for (auto& w : workers)
+        w.join();
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Random lookups over a large, fully resident BufferPool with each frame memory backing. Every
+// lookup fetches a random page under a read guard and reads a few words at random offsets in
+// it, as a B+ tree probe would, so the cost is dominated by cache and TLB misses on the frame
+// arena. A mode the system cannot provide falls back, the "active" column shows what ran.
+// MAP_HUGETLB needs reserved huge pages, e.g. sysctl vm.nr_hugepages=<pool MiB / 2 + 1>.
+//
+// Usage: huge_page_bench [poolMiB] [lookups]
+
+#include "pebble/core/BufferPool.h"
+#include "pebble/core/PageArena.h"
+
+#include "BenchFileManagers.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace pebble::core;
+using pebble::bench::BenchFileManager;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int PROBES_PER_PAGE = 4;
+
+    void run(HugePageMode mode, size_t frames, size_t lookups) {
+        BenchFileManager fm;
+        BufferPool pool(fm, frames, ReplacementPolicyType::LRU, 1, mode);
+
+        // Pages start at 2: page 0 is the meta page, page 1 the catalog
+        for (uint32_t i = 0; i < frames; ++i)
+            pool.fetchPageRead(i + 2);
+
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<uint32_t> pick(2, static_cast<uint32_t>(frames + 1));
+        std::uniform_int_distribution<size_t> offset(0, PAYLOAD_SIZE / sizeof(uint64_t) - 1);
+        uint64_t sum = 0;
+
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < lookups; ++i) {
+            ReadPageGuard guard = pool.fetchPageRead(pick(rng));
+            const char* payload = guard.page().payload();
+            for (int p = 0; p < PROBES_PER_PAGE; ++p) {
+                uint64_t word;
+                std::memcpy(&word, payload + offset(rng) * sizeof(uint64_t), sizeof(word));
+                sum += word;
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / lookups;
+        volatile uint64_t keep = sum;
+        (void)keep;
+
+        std::printf("%-12s %-12s %12.1f\n", hugePageModeName(mode), hugePageModeName(pool.hugePageMode()), ns);
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t poolMiB = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+    size_t lookups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000000;
+    size_t frames = poolMiB * 1024 * 1024 / PAGE_SIZE;
+
+    std::printf("%zu MiB pool (%zu frames), %zu random lookups, %d probes per page\n", poolMiB, frames, lookups,
+                PROBES_PER_PAGE);
+    std::printf("%-12s %-12s %12s\n", "requested", "active", "ns/lookup");
+    for (HugePageMode mode : { HugePageMode::NONE, HugePageMode::TRANSPARENT, HugePageMode::HUGETLB })
+        run(mode, frames, lookups);
+    return 0;
+}
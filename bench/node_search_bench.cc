@@ -0,0 +1,96 @@
+// Cost of searching one full B+ tree node (MAX_KEYS keys) for a random key: the linear getKey()
+// scan the tree used before, KeySearch's scalar branch-free binary search, and the same with the
+// vector compare that BPlusTreeNode uses now. Runs over one node, which stays in L1, and over
+// enough nodes that each search starts from cold cache lines, as in a tree larger than the CPU
+// caches. Each figure is the best of a few rounds.
+//
+// Usage: node_search_bench [searches] [coldNodes]
+
+#include "pebble/core/BPlusTreeNode.h"
+#include "pebble/core/KeySearch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace pebble::core;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // The child index search before KeySearch
+    int linearChildIndex(const BPlusTreeNode& node, int key) {
+        int i = 0;
+        while (i < node.getNumKeys() && key >= node.getKey(i))
+            ++i;
+        return i;
+    }
+
+    constexpr int ROUNDS = 3;
+
+    // search(node index, key)
+    template <typename Search>
+    double nsPerSearch(const std::vector<int>& keys, const std::vector<uint32_t>& order, Search&& search) {
+        double best = 0;
+        for (int round = 0; round < ROUNDS; ++round) {
+            long sum = 0;
+            auto t0 = Clock::now();
+            for (size_t i = 0; i < keys.size(); ++i)
+                sum += search(order[i], keys[i]);
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / keys.size();
+            volatile long keep = sum;
+            (void)keep;
+            best = round == 0 ? ns : std::min(best, ns);
+        }
+        return best;
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t searches = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    size_t coldNodes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16384;
+
+    // Full internal nodes, keys 0, 3, 6, ...
+    std::vector<Page> pages(coldNodes);
+    std::vector<BPlusTreeNode> nodes;
+    nodes.reserve(coldNodes);
+    for (Page& page : pages) {
+        BPlusTreeNode& node = nodes.emplace_back(page);
+        node.setLeaf(false);
+        node.setNumKeys(MAX_KEYS);
+        for (int i = 0; i < MAX_KEYS; ++i)
+            node.setKey(i, 3 * i);
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pickKey(-1, 3 * MAX_KEYS);
+    std::uniform_int_distribution<uint32_t> pickNode(0, static_cast<uint32_t>(coldNodes - 1));
+    std::vector<int> keys(searches);
+    std::vector<uint32_t> hot(searches, 0), cold(searches);
+    for (size_t i = 0; i < searches; ++i) {
+        keys[i] = pickKey(rng);
+        cold[i] = pickNode(rng);
+    }
+
+    std::printf("%d keys per node, %zu searches, cold: %zu nodes (%zu MiB), vector compare: %s\n", MAX_KEYS, searches,
+                coldNodes, coldNodes * PAGE_SIZE >> 20, keySearchInstructionSet());
+    std::printf("%-8s %14s %14s %14s\n", "", "linear ns", "binary ns", "binary+simd ns");
+    auto linear = [&](uint32_t i, int key) { return linearChildIndex(nodes[i], key); };
+    auto binary = [&](uint32_t i, int key) {
+        return keyUpperBoundPortable(pages[i].payload() + NODE_HEADER_SIZE_INTERNAL, MAX_KEYS, key);
+    };
+    auto vector = [&](uint32_t i, int key) {
+        return keyUpperBound(pages[i].payload() + NODE_HEADER_SIZE_INTERNAL, MAX_KEYS, key);
+    };
+    for (auto [name, order] : { std::pair{ "hot", &hot }, std::pair{ "cold", &cold } }) {
+        std::printf("%-8s %14.1f %14.1f %14.1f\n", name, nsPerSearch(keys, *order, linear),
+                    nsPerSearch(keys, *order, binary), nsPerSearch(keys, *order, vector));
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Replay page-access traces against every BufferPool replacement policy and report hit rates.
+//
+// A trace is a text file of page IDs (whitespace separated) in fetch order, as recorded with
+// BufferPool::setAccessTrace(). Without trace files, one is recorded from a built-in workload:
+// random point lookups (index descent + heap read) interleaved with full heap scans, the pattern
+// that flushes hot B+ tree nodes out of a plain LRU pool.
+//
+// Usage: policy_replay [frames] [trace...]
+
+#include "pebble/core/BPlusTree.h"
+#include "pebble/core/BufferPool.h"
+#include "pebble/core/HeapFile.h"
+#include "pebble/core/PosixFileManager.h"
+#include "pebble/core/ReplacementPolicyFactory.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace pebble::core;
+
+namespace {
+
+    constexpr ReplacementPolicyType POLICIES[] = {
+        ReplacementPolicyType::LRU,
+        ReplacementPolicyType::LRU_K,
+        ReplacementPolicyType::TWO_Q,
+        ReplacementPolicyType::ARC,
+    };
+
+    std::vector<uint32_t> loadTrace(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            std::fprintf(stderr, "Cannot read trace %s\n", path.c_str());
+            std::exit(1);
+        }
+
+        std::vector<uint32_t> trace;
+        for (uint32_t pageID; in >> pageID; )
+            trace.push_back(pageID);
+        return trace;
+    }
+
+    // Build a collection, then trace lookups and scans on it; the trace is also saved to tracePath
+    std::vector<uint32_t> recordTrace(const std::string& tracePath) {
+        constexpr int KEYS = 20000;
+        constexpr int ROUNDS = 8;
+        constexpr int LOOKUPS_PER_SCAN = 2000;
+
+        std::string dbPath = "policy_replay.db";
+        std::remove(dbPath.c_str());
+
+        std::vector<uint32_t> trace;
+        {
+            PosixFileManager fm(dbPath);
+            BufferPool pool(fm, 4096);
+
+            HeapFile heap("replay", pool);
+            BPlusTree index(pool);
+            std::string value(96, 'v');
+            for (int key = 0; key < KEYS; ++key)
+                index.insert(key, heap.insert(value));
+
+            pool.setAccessTrace([&](uint32_t pageID) { trace.push_back(pageID); });
+
+            std::mt19937 rng(42);
+            std::uniform_int_distribution<int> pick(0, KEYS - 1);
+            for (int round = 0; round < ROUNDS; ++round) {
+                for (int i = 0; i < LOOKUPS_PER_SCAN; ++i) {
+                    if (auto rid = index.search(pick(rng)))
+                        heap.get(*rid);
+                }
+                heap.scan([](uint64_t, const std::string&) {});
+            }
+
+            pool.setAccessTrace({});
+        }
+        std::remove(dbPath.c_str());
+
+        std::ofstream out(tracePath);
+        for (uint32_t pageID : trace)
+            out << pageID << '\n';
+        return trace;
+    }
+
+    // Same bookkeeping as BufferPool, without pins or I/O
+    double hitRate(ReplacementPolicyType type, const std::vector<uint32_t>& trace, size_t frames) {
+        auto policy = createReplacementPolicy(type, frames);
+        std::unordered_map<uint32_t, uint32_t> resident;       // { pageID, frame }
+        std::vector<uint32_t> pageOf(frames);
+        uint64_t hits = 0;
+
+        for (uint32_t pageID : trace) {
+            auto it = resident.find(pageID);
+            if (it != resident.end()) {
+                ++hits;
+                policy->recordHit(it->second);
+                continue;
+            }
+
+            uint32_t frame = static_cast<uint32_t>(resident.size());
+            if (resident.size() >= frames) {
+                policy->forEachVictim([&](uint32_t victim) { frame = victim; return false; });
+                policy->recordEvict(frame);
+                resident.erase(pageOf[frame]);
+            }
+            policy->recordLoad(frame, pageID);
+            resident[pageID] = frame;
+            pageOf[frame] = pageID;
+        }
+
+        return trace.empty() ? 0.0 : 100.0 * hits / trace.size();
+    }
+
+    void report(const std::string& name, const std::vector<uint32_t>& trace, size_t frames) {
+        std::unordered_set<uint32_t> distinct(trace.begin(), trace.end());
+        std::printf("%s: %zu accesses, %zu distinct pages, %zu frames\n", name.c_str(), trace.size(), distinct.size(), frames);
+
+        for (ReplacementPolicyType type : POLICIES) {
+            auto policy = createReplacementPolicy(type, frames);
+            std::printf("  %-6s %6.2f%% hits\n", policy->name(), hitRate(type, trace, frames));
+        }
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t frames = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+
+    if (argc <= 2) {
+        std::string tracePath = "policy_replay.trace";
+        report(tracePath + " (lookups + scans)", recordTrace(tracePath), frames);
+        return 0;
+    }
+
+    for (int i = 2; i < argc; ++i)
+        report(argv[i], loadTrace(argv[i]), frames);
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Restart of a BufferPool over a B+ tree larger than the pool, cold against warm. A first run
+// builds the tree, serves skewed lookups (90% on a tenth of the keys) and shuts down, saving its
+// resident pages for warm restart. Then the tree is reopened twice with an empty pool: once
+// serving the same lookups straight away, once after warmUp() reloaded the saved pages. Reported
+// per start: warmup time, and hit rate and time of the first lookups. Use a backend that bypasses
+// the OS page cache (direct, the default), else both starts read from memory.
+//
+// Usage: warm_restart_bench [keys] [poolFrames] [lookups] [backend] [path]
+
+#include "pebble/core/BPlusTree.h"
+#include "pebble/core/BufferPool.h"
+#include "pebble/core/FileManagerFactory.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+using namespace pebble::core;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // The same skewed key sequence on every call
+    template <typename Fn>
+    void forEachLookup(int keys, size_t lookups, Fn&& fn) {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> hot(0, keys / 10 - 1);
+        std::uniform_int_distribution<int> any(0, keys - 1);
+        std::uniform_int_distribution<int> percent(0, 99);
+        for (size_t i = 0; i < lookups; ++i)
+            fn(percent(rng) < 90 ? hot(rng) : any(rng));
+    }
+
+    struct Run {
+        WarmupStats warmup;
+        double hitRate = 0;
+        double lookupSeconds = 0;
+    };
+
+    Run reopen(FileManagerType backend, const std::string& path, size_t frames, uint32_t root, int keys,
+               size_t lookups, bool warm) {
+        auto fm = createFileManager(backend, path);
+        BufferPool pool(*fm, frames);
+        Run run;
+        if (warm) {
+            pool.setWarmRestartFile(path + ".hot");
+            run.warmup = pool.warmUp();
+            pool.setWarmRestartFile("");     // keep the file of the first run for the next start
+        }
+
+        BPlusTree tree(pool, root);
+        BufferPoolStats before = pool.stats();
+        auto t0 = Clock::now();
+        forEachLookup(keys, lookups, [&](int key) { tree.search(key); });
+        run.lookupSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+        BufferPoolStats after = pool.stats();
+        uint64_t fetches = after.fetches - before.fetches;
+        run.hitRate = fetches ? static_cast<double>(after.hits - before.hits) / fetches : 0.0;
+        return run;
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    int keys = argc > 1 ? std::atoi(argv[1]) : 100000;
+    size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+    size_t lookups = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5000;
+    std::string backendName = argc > 4 ? argv[4] : "direct";
+    auto parsed = parseFileManagerType(backendName);
+    if (!parsed) {
+        std::fprintf(stderr, "Unknown file manager backend: %s\n", backendName.c_str());
+        return 1;
+    }
+    FileManagerType backend = *parsed;
+    std::string path = argc > 5 ? argv[5] : "warm_restart_bench.db";
+    std::remove(path.c_str());
+    std::remove((path + ".hot").c_str());
+
+    // Build with a pool that holds the whole tree, then run the workload in a pool of `frames`
+    uint32_t root;
+    size_t nodes;
+    {
+        auto fm = createFileManager(backend, path);
+        BufferPool pool(*fm, static_cast<size_t>(keys));
+        BPlusTree tree(pool);
+        for (int key = 0; key < keys; ++key)
+            tree.insert(key, static_cast<uint64_t>(key));
+        root = tree.rootPageID();
+        nodes = tree.nodePages().size();
+    }
+    {
+        auto fm = createFileManager(backend, path);
+        BufferPool pool(*fm, frames);
+        pool.setWarmRestartFile(path + ".hot");
+        BPlusTree tree(pool, root);
+        forEachLookup(keys, lookups, [&](int key) { tree.search(key); });
+    }
+
+    Run cold = reopen(backend, path, frames, root, keys, lookups, false);
+    Run warm = reopen(backend, path, frames, root, keys, lookups, true);
+    std::remove(path.c_str());
+    std::remove((path + ".hot").c_str());
+
+    std::printf("%d keys in %zu nodes, %zu frames, %s backend, first %zu lookups after restart\n", keys, nodes, frames,
+                backendName.c_str(), lookups);
+    std::printf("%-6s %12s %12s %10s %12s\n", "", "warmup ms", "pages", "hit rate", "lookups ms");
+    for (auto [name, run] : { std::pair{ "cold", &cold }, std::pair{ "warm", &warm } }) {
+        std::printf("%-6s %12.1f %12zu %9.1f%% %12.1f\n", name, run->warmup.seconds * 1000, run->warmup.loaded,
+                    run->hitRate * 100, run->lookupSeconds * 1000);
+    }
+    return 0;
+}
@@ -5,7 +5,7 @@
 #include "pebble/core/BPlusTree.h"
 #include "pebble/core/BufferPool.h"
 #include "pebble/core/IFileManager.h"
-#include "pebble/core/WindowsFileManager.h"
+#include "pebble/core/FileManagerFactory.h"
 
 #include <unordered_map>
 #include <memory>
@@ -18,8 +18,15 @@ namespace pebble {
 		class StorageEngine
 		{
 		public:
+			// Open dbPath with the platform's default file manager
 			StorageEngine(const std::string& dbPath, size_t poolSize);
 
+			// Run on top of any IFileManager backend, with the buffer pool's replacement policy.
+			// maxPoolSize: how far resizeBufferPool() can grow the pool, 0 for poolSize.
+			StorageEngine(std::unique_ptr<pebble::core::IFileManager> fileManager, size_t poolSize,
+				pebble::core::ReplacementPolicyType policy = pebble::core::ReplacementPolicyType::LRU,
+				size_t maxPoolSize = 0);
+
 			// Collection Management
 			bool createCollection(const std::string& name);
 			bool dropCollection(const std::string& name);
@@ -36,8 +43,25 @@ namespace pebble {
 			void printHeap(const std::string& collection);
 			void printFreeList();
 
+			// Per collection heap: compression ratio and codec throughput (compressed backend only)
+			void printCompressionStats();
+
+			// Buffer pool size, hit rate, evictions, eviction stalls on dirty pages, cleaner throughput and huge page mode
+			void printBufferPoolStats() const;
+
+			// Grow or shrink the buffer pool to `frames` while serving, see BufferPool::resize().
+			// False if out of range.
+			bool resizeBufferPool(size_t frames);
+
+			// Save the pool's resident pages to hotPagesPath on every flush and at shutdown, and load
+			// the ones saved by the last run now, reporting how long it took
+			void enableWarmRestart(const std::string& hotPagesPath);
+
+			// Move live pages from the end of the file into free pages, then truncate the file
+			void shrink();
+
 		private:
-			pebble::core::WindowsFileManager m_FileManager;
+			std::unique_ptr<pebble::core::IFileManager> m_FileManager;
 			pebble::core::BufferPool m_BufferPool;
 			pebble::core::CatalogManager m_CatalogManager;
 
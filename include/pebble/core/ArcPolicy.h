@@ -0,0 +1,67 @@
+#pragma once
+
+#include "pebble/core/IReplacementPolicy.h"
+#include "pebble/core/FrameList.h"
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // Adaptive Replacement Cache (Megiddo & Modha). T1 holds pages seen once recently, T2 pages
+        // seen at least twice; ghost lists B1/B2 remember what was evicted from each. A hit in a
+        // ghost list moves the target size of T1 towards the side that would have kept the page,
+        // so the split between recency and frequency adapts to the workload. Scans only churn T1.
+        //
+        // The pool evicts before it loads, so the choice between T1 and T2 is made without knowing
+        // whether the incoming page is a B2 ghost (the paper's tie rule for |T1| == p).
+        class ArcPolicy : public IReplacementPolicy {
+        public:
+            explicit ArcPolicy(size_t capacity);
+
+            void recordHit(uint32_t frame) override;
+            void recordLoad(uint32_t frame, uint32_t pageID) override;
+            void recordEvict(uint32_t frame) override;
+            void forget(uint32_t frame) override;
+            void forEachVictim(const std::function<bool(uint32_t frame)>& fn) const override;
+
+            const char* name() const override { return "arc"; }
+
+            // Current target size of T1
+            size_t target() const { return m_Target; }
+
+        private:
+            enum class Queue : uint8_t { NONE, T1, T2, B1, B2 };
+
+            struct Ghost {
+                Queue queue;
+                std::list<uint32_t>::iterator pos;
+            };
+
+            FrameLinks::List& resident(Queue queue) { return queue == Queue::T1 ? m_T1 : m_T2; }
+            std::list<uint32_t>& ghosts(Queue queue) { return queue == Queue::B1 ? m_B1 : m_B2; }
+
+            void unlink(uint32_t frame);
+            void admit(Queue queue, uint32_t frame);
+            void addGhost(Queue queue, uint32_t pageID);
+            void dropLru(Queue queue);
+            void trimGhosts();
+            size_t directorySize() const { return m_T1.size + m_T2.size + m_B1.size() + m_B2.size(); }
+
+            size_t m_Capacity;
+            size_t m_Target = 0;
+
+            FrameLinks m_Links;
+            FrameLinks::List m_T1, m_T2;        // resident, most recent at head
+            std::vector<Queue> m_Queue;         // per frame: T1, T2 or NONE
+            std::vector<uint32_t> m_PageIDs;    // per frame
+
+            std::list<uint32_t> m_B1, m_B2;     // ghosts, page IDs only, most recent at front
+            std::unordered_map<uint32_t, Ghost> m_Ghosts;
+        };
+
+    }
+}
@@ -3,8 +3,13 @@
 #include "pebble/core/BufferPool.h"
 #include "pebble/core/BPlusTreeNode.h"
 
+#include <cmath>
 #include <cstdint>
+#include <functional>
 #include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace pebble {
@@ -13,35 +18,29 @@ namespace pebble {
         class BPlusTree
         {
         public:
-            // Constructor for NEW B+Tree
-            BPlusTree(BufferPool& bp, int order = 4)
-                : m_BufferPool(bp), m_Order(order)
+            // Constructor for NEW B+Tree. The default order fills a page, see DEFAULT_ORDER
+            BPlusTree(BufferPool& bp, int order = DEFAULT_ORDER)
+                : m_BufferPool(bp), m_Order(checkOrder(order))
             {
-                m_MinKeys = std::ceil(order / 2.0) - 1;
-                m_RootPageID = m_BufferPool.allocatePage();
+                m_MinKeys = std::ceil(m_Order / 2.0) - 1;
 
-                Page& page = m_BufferPool.fetchPage(m_RootPageID);
-                BPlusTreeNode rootNode(page);
+                WritePageGuard guard = allocateNode();
+                m_RootPageID = guard.pageID();
+                BPlusTreeNode rootNode(guard.page());
                 rootNode.setLeaf(true);
-
-                m_BufferPool.markDirty(m_RootPageID);
-                m_BufferPool.unpinPage(m_RootPageID);
             }
 
-            // Constructor for loading an existing B+Tree from a known root
-            BPlusTree(BufferPool& bp, uint32_t rootPageID, int order = 4)
-                : m_BufferPool(bp), m_Order(order), m_RootPageID(rootPageID)
+            // Constructor for loading an existing B+Tree from a known root, with the order it was
+            // built with: every node stores it
+            BPlusTree(BufferPool& bp, uint32_t rootPageID)
+                : m_BufferPool(bp), m_RootPageID(rootPageID)
             {
-                m_MinKeys = std::ceil(order / 2.0) - 1;
                 // Do NOT allocate a new page
-                // Do NOT overwrite the root page
+                // Do NOT overwrite the root page, it already says whether it is a leaf
                 // Just load the tree rooted at rootPageID
-                Page& page = m_BufferPool.fetchPage(m_RootPageID);
-                BPlusTreeNode rootNode(page);
-                rootNode.setLeaf(true);
-
-                m_BufferPool.markDirty(m_RootPageID);
-                m_BufferPool.unpinPage(m_RootPageID);
+                ReadPageGuard guard = m_BufferPool.fetchPageRead(m_RootPageID);
+                m_Order = checkOrder(BPlusTreeNode(guard.page()).getOrder());
+                m_MinKeys = std::ceil(m_Order / 2.0) - 1;
             }
 
             bool insert(int key, uint64_t value);                 // Insert key:value pair
@@ -51,7 +50,16 @@ namespace pebble {
 
             void print();
 
+            // Every node page, level by level from the root
+            std::vector<PageID> nodePages();
+
+            // Fix root, child and next-leaf pointers after BufferPool::movePage() moved some nodes
+            // (old ID -> new ID), and pass every leaf value through remapValue
+            void relocate(const std::unordered_map<PageID, PageID>& moved,
+                          const std::function<uint64_t(uint64_t)>& remapValue);
+
             uint32_t rootPageID() const { return m_RootPageID; }
+            int order() const { return m_Order; }
 
         private:
             BufferPool& m_BufferPool;
@@ -70,8 +78,8 @@ namespace pebble {
             // Recursive helper for remove
             bool removeInternal(int key, PageID nodeID, bool& deleted);
 
-            // Merge helper
-            void mergeNodes(PageID leftID, PageID rightID, BPlusTreeNode& parent, int separatorIdx);
+            // Merge helper: moves right into left and frees right (releasing its guard)
+            void mergeNodes(WritePageGuard& left, WritePageGuard& right, BPlusTreeNode& parent, int separatorIdx);
 
 
             // ---------------------------------------------- [SEARCH] --------------------------------------------------------
@@ -85,6 +93,17 @@ namespace pebble {
 
             // Utility
             int findChildIndex(BPlusTreeNode& parent, int key);
+
+            // New, blank node page of this tree close to nearPageID, hinted as randomly accessed
+            WritePageGuard allocateNode(PageID nearPageID = 0);
+
+            static int checkOrder(int order) {
+                if (order < MIN_ORDER || order > MAX_ORDER)
+                    throw std::invalid_argument("B+ tree order must be between " + std::to_string(MIN_ORDER) +
+                                                " and " + std::to_string(MAX_ORDER) + ", got " +
+                                                std::to_string(order));
+                return order;
+            }
         };
 
     }
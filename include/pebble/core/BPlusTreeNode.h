@@ -10,6 +10,7 @@
 /*
 | Field                      | Offset       | Size                                                   |
 | -------------------------- | ------------ | ------------------------------------------------------ |
+| `Order`                    | 0            | 2 bytes, order of the tree the node belongs to         |
 | `NumKeys`                  | 2            | 2 bytes                                                |
 | `NextLeaf` (only if leaf)  | 4            | 4 bytes (optional)                                     |
 | `Keys[0...n-1]`            | after header | `n * sizeof(int)`                                      |
@@ -20,33 +21,63 @@
 namespace pebble {
     namespace core {
 
-        constexpr size_t NODE_TYPE_OFFSET = 0;            // PageType (2 bytes)
+        constexpr size_t NODE_ORDER_OFFSET = 0;            // uint16_t order of the tree (2 bytes), the type is in the page header
         constexpr size_t NODE_NUM_KEYS_OFFSET = 2;            // uint16_t numKeys (2 bytes)
         constexpr size_t NODE_NEXT_LEAF_OFFSET = 4;            // uint32_t nextLeaf (4 bytes, only if leaf)
         constexpr size_t NODE_HEADER_SIZE_LEAF = 8;            // 2 + 2 + 4
         constexpr size_t NODE_HEADER_SIZE_INTERNAL = 4;            // 2 + 2
 
-        static constexpr int MAX_KEYS = 31;
+        // Node capacity follows the page size. An internal node is the larger of the two:
+        // header + MAX_KEYS keys + (MAX_KEYS + 1) children must fit the payload.
+        static constexpr int MAX_KEYS = static_cast<int>(
+            (PAYLOAD_SIZE - NODE_HEADER_SIZE_LEAF - sizeof(uint64_t)) / (sizeof(int) + sizeof(uint64_t)));
         static constexpr int MAX_CHILDREN = MAX_KEYS + 1;
         static constexpr int MAX_VALUES = MAX_KEYS;
 
+        static_assert(NODE_HEADER_SIZE_LEAF + MAX_KEYS * sizeof(int) + MAX_CHILDREN * sizeof(uint64_t) <= PAYLOAD_SIZE,
+                      "B+ tree node does not fit a page");
+        static_assert(MAX_KEYS <= UINT16_MAX, "numKeys is stored in 16 bits");
+
+        // A node holds order + 1 keys between an insert and its split, so the largest order that fits
+        // a page is one below MAX_KEYS. Trees default to it: the fewest levels, so the fewest page
+        // fetches per lookup.
+        static constexpr int MIN_ORDER = 3;
+        static constexpr int MAX_ORDER = MAX_KEYS - 1;
+        static constexpr int DEFAULT_ORDER = MAX_ORDER;
+
+        static_assert(MIN_ORDER <= MAX_ORDER, "Page too small for a B+ tree node");
+
         constexpr PageID INVALID_PAGE = -1;
 
         class BPlusTreeNode {
         public:
             explicit BPlusTreeNode(Page& page);
 
+            // Read-only view (a page under a ReadPageGuard): only the const accessors may be used
+            explicit BPlusTreeNode(const Page& page);
+
             // Node type
             bool isLeaf() const;
             void setLeaf(bool isLeaf);
 
+            // Order of the tree, stamped on every node when it is allocated
+            int getOrder() const;
+            void setOrder(int order);
+
             // Keys
             int getNumKeys() const;
             void setNumKeys(int n);
             int getKey(int idx) const;
             void setKey(int idx, int key);
 
+            // Searches over the key array, see KeySearch.h: index of the first key >= key / > key
+            int lowerBound(int key) const;
+            int upperBound(int key) const;
+
+            // Index of key, -1 if absent
             int findKeyIndex(int key) const;
+
+            // Child to descend into for key: keys equal to a separator go right
             int findChildIndex(int key) const;
 
             void insertKeyAt(int idx, int key);
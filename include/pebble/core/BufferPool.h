@@ -1,22 +1,52 @@
 #pragma once
 
-#include <unordered_map>
-#include <list>
+#include <memory>
+#include <functional>
+#include <vector>
+#include <span>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
 #include <cstdint>
 #include <stdexcept>
+#include <string>
 
 #include "pebble/core/Page.h"
 #include "pebble/core/IFileManager.h"
+#include "pebble/core/PageTable.h"
+#include "pebble/core/PageArena.h"
+#include "pebble/core/PageGuard.h"
+#include "pebble/core/FrameLatch.h"
+#include "pebble/core/IReplacementPolicy.h"
+#include "pebble/core/ReplacementPolicyFactory.h"
 
 namespace pebble {
     namespace core {
 
-        struct Frame {
+        // Where a frame is in its I/O cycle. Disk I/O runs without the shard latch: a thread that
+        // needs a page being loaded waits on that frame's state only, while other pages of the
+        // shard are fetched and evicted meanwhile.
+        enum class FrameState : uint8_t {
+            FREE,               // no page, or its load failed
+            LOADING,            // in the page table, contents being read; fetchers pin and wait
+            RESIDENT,
+            WRITING_BACK,       // resident, pinned and share-latched while written; reads go on
+        };
+
+        // One slot of the pool's frame array. Cache-line aligned so the bookkeeping of neighbouring
+        // frames never shares a line; the page buffers themselves live in a separate arena.
+        struct alignas(64) Frame {
+            static constexpr uint32_t NO_PAGE = UINT32_MAX;
+
             Page page;
+            uint32_t pageID = NO_PAGE;                             // resident page, NO_PAGE if free
+            std::atomic<FrameState> state{ FrameState::FREE };     // changes are notified, see wait()
             std::atomic<bool> dirty{ false };                      // modified after loading
             std::atomic<int> pinCount{ 0 };                        // number of clients holding this page
+            bool prefetched = false;                               // loaded by prefetch(), not fetched yet
+            FrameLatch latch;                                      // page contents, held by page guards
 
             Frame() = default;
 
@@ -28,8 +58,11 @@ namespace pebble {
             // move constructor
             Frame(Frame&& other) noexcept
                 : page(std::move(other.page)),
+                pageID(other.pageID),
+                state(other.state.load()),
                 dirty(other.dirty.load()),
-                pinCount(other.pinCount.load())
+                pinCount(other.pinCount.load()),
+                prefetched(other.prefetched)
             {
             }
 
@@ -37,8 +70,11 @@ namespace pebble {
             Frame& operator=(Frame&& other) noexcept {
                 if (this != &other) {
                     page = std::move(other.page);
+                    pageID = other.pageID;
+                    state = other.state.load();
                     dirty = other.dirty.load();
                     pinCount.store(other.pinCount.load());
+                    prefetched = other.prefetched;
                 }
                 return *this;
             }
@@ -48,19 +84,69 @@ namespace pebble {
             Frame& operator=(const Frame&) = delete;
         };
 
+        // Write-back activity of a BufferPool since construction, see BufferPool::stats()
+        struct BufferPoolStats {
+            uint64_t evictions = 0;
+            uint64_t stalledEvictions = 0;      // victim was dirty: the fetch waited for a write-back
+            uint64_t stallPagesWritten = 0;     // pages written by those write-backs
+            uint64_t cleanerBatches = 0;
+            uint64_t cleanerPagesWritten = 0;
+            double cleanerSeconds = 0;          // spent in the cleaner's writes
+
+            uint64_t frames = 0;                // frames holding memory: poolSize() once a resize settles
+            uint64_t fetches = 0;               // page lookups, newPage() excluded
+            uint64_t hits = 0;                  // lookups that found the page resident or loading
+
+            double cleanerPagesPerSecond() const { return cleanerSeconds > 0 ? cleanerPagesWritten / cleanerSeconds : 0.0; }
+            double hitRate() const { return fetches ? static_cast<double>(hits) / fetches : 0.0; }
+        };
+
+        // Result of BufferPool::warmUp()
+        struct WarmupStats {
+            size_t pages = 0;                   // listed in the warm restart file, still allocated, that fit
+            size_t loaded = 0;                  // read into the pool
+            double seconds = 0;
+        };
+
+        // Frames are split into shards by a hash of the page ID. Each shard has its own latch, page
+        // table, free frames and replacement state over a fixed slice of the frame array, so threads
+        // working on different pages rarely contend. The slices add up to poolSize, the global cap.
+        // The shard latch only covers that bookkeeping: reads and write-backs are issued after it is
+        // released, with the frame pinned and in a LOADING / WRITING_BACK state.
         class BufferPool
         {
         public:
-            BufferPool(IFileManager& fm, size_t poolSize);
+            // shards: rounded down to a power of two; 0 picks one per hardware thread. Never more
+            // than leave MIN_SHARD_FRAMES frames in each shard, as every page a caller keeps pinned
+            // occupies a frame of one particular shard.
+            // hugePages: backing of the frame memory, falling back as the system allows; see
+            // hugePageMode() for the one in effect.
+            // maxPoolSize: how far resize() can grow the pool, 0 for poolSize. Frames are reserved
+            // up to it, but take memory only once used.
+            BufferPool(IFileManager& fm, size_t poolSize, ReplacementPolicyType policy = ReplacementPolicyType::LRU,
+                       size_t shards = 0, HugePageMode hugePages = HugePageMode::NONE, size_t maxPoolSize = 0);
 
             ~BufferPool();
 
             // Fetch page into buffer pool if not already present, pin the page ( pinCount++ )
             Page& fetchPage(uint32_t pageID);
 
+            // Fetch and pin pageID, then latch its frame shared / exclusive. Only the fetch takes
+            // the pool's latch: the guard unlatches, unpins and (write guard) marks the page dirty
+            // on its own. A thread must not hold two guards on the same page.
+            ReadPageGuard fetchPageRead(uint32_t pageID);
+            WritePageGuard fetchPageWrite(uint32_t pageID);
+
+            // Allocate a page near nearPageID and pin it in a zeroed, dirty, write-latched frame.
+            // No I/O: the page reaches disk when it is evicted or flushed.
+            WritePageGuard newPage(uint32_t nearPageID = 0);
+
             // Allocate a new Page via FileManager
             uint32_t allocatePage();
 
+            // Allocate `count` contiguous pages near nearPageID, returns the first pageID
+            uint32_t allocatePages(uint32_t count, uint32_t nearPageID);
+
             // Mark page as dirty ( modified )
             void markDirty(uint32_t pageID);
 
@@ -75,19 +161,181 @@ namespace pebble {
 
             void freePage(uint32_t pageID);
 
+            // Copy page fromPageID into toPageID (already allocated) and free fromPageID.
+            // References to the old ID are the caller's to rewrite.
+            void movePage(uint32_t fromPageID, uint32_t toPageID);
+
+            // Warm pages that will be fetched soon. Never evicts: with an async-capable file manager,
+            // missing pages are read into free frames as one batch, otherwise only the OS is hinted.
+            void prefetch(std::span<const uint32_t> pageIDs);
+
+            // Run a background thread that keeps the coldest cleanFraction of every shard's frames
+            // (the next victims in replacement order) clean, writing their dirty pages in batches,
+            // so evictions rarely wait for a write. It keeps going while it
+            // finds pages to write, then sleeps for interval or until an eviction had to write back. Restarts a running cleaner.
+            void startCleaner(double cleanFraction = 0.1,
+                              std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+
+            // Stop the cleaner, if running, once its current batch is written
+            void stopCleaner();
+
+            // Warm restart: flushAll() (so also destruction) saves the IDs of the resident pages to
+            // path, hottest first in replacement order, and warmUp() loads them back into free
+            // frames, in page order batches, at most `readers` reads at a time without async I/O.
+            // Loading never evicts and the pool serves fetches meanwhile. An empty path disables it.
+            void setWarmRestartFile(std::string path);
+            WarmupStats warmUp(unsigned readers = 8);
+
+            BufferPoolStats stats() const;
+
+            // Change the number of frames in use, between shardCount() and capacity(), keeping in
+            // mind that every page pinned at a time takes a frame of its shard. Growing is
+            // immediate. Shrinking releases free frames at once, then evicts victims a few at a
+            // time, dirty ones written back first, so fetches go on meanwhile; their memory goes
+            // back to the system. Frames pinned now are released when they are next evicted.
+            void resize(size_t poolSize);
+
+            size_t poolSize() const { return m_PoolSize.load(std::memory_order_relaxed); }
+            size_t capacity() const { return m_MaxPages; }
+
+            // Forward an access-pattern hint for a run of pages to the file manager
+            void adviseAccess(uint32_t pageID, uint32_t numPages, AccessPattern pattern);
+
+            size_t shardCount() const { return m_Shards.size(); }
+            const char* replacementPolicyName() const { return m_Shards.front()->policy->name(); }
+            HugePageMode hugePageMode() const { return m_Arena.mode(); }
+
+            // Call sink with the ID of every fetchPage(), serialized across threads (recording
+            // traces for policy replay). An empty function stops tracing.
+            void setAccessTrace(std::function<void(uint32_t pageID)> sink);
+
+            static constexpr size_t MIN_SHARD_FRAMES = 64;
+
         private:
+            // Frames [firstFrame, firstFrame + frameCount) of m_Frames and everything that indexes
+            // them, guarded by mutex. The policy numbers the slice from 0. Only frameLimit frames
+            // are in use at a time, the others are retired: no page, no memory.
+            struct alignas(64) Shard {
+                std::mutex mutex;
+                uint32_t firstFrame;
+                uint32_t frameCount;
+                uint32_t frameLimit;                            // this shard's share of poolSize()
+                PageTable pageTable;                            // { pageID, frame index }
+                std::vector<uint32_t> freeFrames;               // unoccupied frame indices
+                std::vector<uint32_t> retiredFrames;            // frames beyond frameLimit
+                std::unique_ptr<IReplacementPolicy> policy;     // eviction order of occupied frames
+                uint32_t writingBack = 0;                       // frames in WRITING_BACK
+                std::condition_variable writtenBack;            // a write-back batch finished
+                uint64_t fetches = 0;                           // see BufferPoolStats
+                uint64_t hits = 0;
+
+                Shard(uint32_t first, uint32_t count, uint32_t limit, ReplacementPolicyType type);
+
+                bool overLimit() const { return frameCount - retiredFrames.size() > frameLimit; }
+            };
+
             IFileManager& m_FileManager;
-            size_t m_MaxPages;
-            std::mutex m_Mutex;
+            size_t m_MaxPages;                                  // capacity, frames reserved
+            std::atomic<size_t> m_PoolSize;                     // frames in use, see resize()
+            std::mutex m_ResizeMutex;                           // one resize at a time
+
+            // Everything is sized at construction; fetching never allocates
+            PageArena m_Arena;                                  // m_MaxPages page buffers, contiguous
+            std::vector<Frame> m_Frames;                        // frame i views arena page i
+            std::vector<std::unique_ptr<Shard>> m_Shards;       // power-of-two count
+            uint32_t m_ShardMask;
+
+            std::atomic<bool> m_Tracing{ false };
+            std::mutex m_TraceMutex;
+            std::function<void(uint32_t)> m_AccessTrace;
+
+            std::mutex m_PrefetchMutex;                         // one async batch at a time
+
+            std::mutex m_WarmRestartMutex;                      // guards the path and its file
+            std::string m_WarmRestartPath;
+
+            // Background cleaner
+            std::thread m_Cleaner;
+            std::mutex m_CleanerMutex;                          // guards the three fields below
+            std::condition_variable m_CleanerWake;
+            bool m_CleanerStop = false;
+            bool m_CleanerKicked = false;                       // an eviction had to write back
+            double m_CleanFraction = 0.1;
+            std::chrono::milliseconds m_CleanerInterval{ 10 };
+
+            std::atomic<uint64_t> m_Evictions{ 0 };
+            std::atomic<uint64_t> m_StalledEvictions{ 0 };
+            std::atomic<uint64_t> m_StallPagesWritten{ 0 };
+            std::atomic<uint64_t> m_CleanerBatches{ 0 };
+            std::atomic<uint64_t> m_CleanerPagesWritten{ 0 };
+            std::atomic<uint64_t> m_CleanerNanos{ 0 };
+
+            Shard& shardOf(uint32_t pageID);
+
+            // fetchPage(), returning the pinned frame. fresh: pageID was just allocated, zero the
+            // frame instead of reading it and mark it dirty.
+            Frame& pinFrame(uint32_t pageID, bool fresh = false);
+
+            // Wait for a frame pinned in LOADING state. False if the load failed: the pin is dropped.
+            bool awaitLoad(Shard& shard, Frame& frame);
+
+            // Complete a load issued without the shard latch, dropping the loader's pin on failure
+            void finishLoad(Shard& shard, Frame& frame, bool loaded);
+
+            // Drop a pin on a frame whose load failed, freeing it with the last one. Shard latched.
+            void unpinFailedLoad(Shard& shard, Frame& frame);
+
+            // A free frame of the shard, evicting a victim if there is none. Returns NO_FRAME after
+            // releasing `lock` to write back dirty victims or wait for a write-back in flight; the
+            // caller re-locks and starts over, as the shard may have changed.
+            uint32_t takeFreeFrame(Shard& shard, std::unique_lock<std::mutex>& lock);
+
+            // evict a victim page, returns its frame (now free), or NO_FRAME as above
+            uint32_t evictPage(Shard& shard, std::unique_lock<std::mutex>& lock);
+
+            // The policy's first unpinned victim, a slot of the shard, or NO_FRAME
+            uint32_t pickVictim(Shard& shard) const;
+
+            // Drop the clean, unpinned page in the shard's slot, leaving its frame free
+            void dropPage(Shard& shard, uint32_t slot);
+
+            // Shard latched: retire free frames while the shard is over its limit / retire one
+            void trimFreeFrames(Shard& shard);
+            void retireFrame(Shard& shard, uint32_t index);
+
+            // Evict until the shard is within its limit or has only pinned pages left
+            void shrinkShard(Shard& shard);
+
+            // Under the shard latch: pin, share-latch and mark WRITING_BACK the unpinned dirty frames
+            // among the policy's next `window` victims, at most `limit` of them
+            std::vector<Frame*> beginWriteBack(Shard& shard, size_t window, size_t limit);
+
+            // Without the shard latch: write a batch from beginWriteBack() and make its frames
+            // RESIDENT again (dirty again if the write fails)
+            void writeBack(Shard& shard, const std::vector<Frame*>& frames);
+
+            // Read the missing ones of pageIDs into free frames, left unpinned and RESIDENT, async
+            // or over `readers` threads. Never evicts. Returns the number of pages read.
+            // prefetched: the load counts as the first fetch's reference, see Frame::prefetched.
+            size_t loadPages(std::span<const uint32_t> pageIDs, unsigned readers, bool prefetched);
+
+            // IDs of the resident pages, hottest first. All shards latched.
+            std::vector<uint32_t> residentPages() const;
+
+            // Write them to the warm restart file, if one is set. No shard latched.
+            void saveResidentPages(const std::vector<uint32_t>& hot);
 
-            std::unordered_map<uint32_t, Frame> m_Pages;        // { pageID, Frame }
-            std::list<uint32_t> m_LRU;                          // pageIDs, oldest at front
+            void cleanerLoop();
 
-            // update cache
-            void touchLRU(uint32_t pageID);
+            // Write back the dirty pages among the shard's coldest frames, one batch at a time.
+            // Returns the number of pages written.
+            size_t cleanShard(Shard& shard);
 
-            // evict a victime page
-            void evictPage();
+            static constexpr size_t EVICTION_WRITE_BATCH = 64;
+            static constexpr size_t CLEANER_WRITE_BATCH = 64;
+            static constexpr size_t SHRINK_BATCH = 32;          // evictions per latch hold
+            static constexpr size_t WARMUP_BATCH = 256;
+            static constexpr uint32_t WARM_RESTART_MAGIC = 0x54524d57;   // "WMRT"
         };
 
     }
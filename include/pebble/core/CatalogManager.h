@@ -30,6 +30,9 @@ namespace pebble
 
             std::vector<CatalogEntry> getCollections() const;
 
+            // Write changed entries to the catalog pages in the buffer pool (also done on destruction)
+            void flush();
+
         private:
             BufferPool& m_BufferPool;
             const PageID m_CatalogRootPageID = 1;
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "pebble/core/PosixFileManager.h"
+#include "pebble/core/CompressionMap.h"
+
+#include <array>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // PosixFileManager that stores HEAP pages as LZ-compressed images. Callers, the BufferPool
+        // included, still read and write whole uncompressed pages.
+        //
+        // An image of c * SLOT_UNIT bytes (slot class c) goes to a bucket: c consecutive pages split
+        // into SLOTS_PER_BUCKET slots of that size, so no class wastes space. The CompressionMap
+        // records each page's bucket, slot and length. A slot the map stops pointing at, like the
+        // page's own slot in the file, is only reused or punched out once that map has been flushed,
+        // so the map on disk never points at another page's image. Pages that do not shrink to at
+        // least one slot unit below PAGE_SIZE, and all non-heap pages, are stored in place.
+        class CompressedFileManager : public PosixFileManager {
+        public:
+            explicit CompressedFileManager(const std::string& filename);
+            ~CompressedFileManager();
+
+            void readPage(uint32_t pageID, Page& page) override;
+            void writePage(const Page& page) override;
+            void writePages(std::vector<const Page*> pages) override;
+            uint32_t allocatePages(uint32_t count, uint32_t nearPageID) override;
+            void freePage(uint32_t pageID) override;
+            void flush() override;
+            uint32_t shrink() override;
+
+            void prefetch(std::span<const uint32_t> pageIDs) override;
+
+            std::optional<CompressionStats> compressionStats(std::span<const uint32_t> pageIDs) override;
+
+            static constexpr uint32_t SLOTS_PER_BUCKET = 8;
+            static constexpr size_t SLOT_UNIT = PAGE_SIZE / SLOTS_PER_BUCKET;     // 512 bytes with 4 KiB pages
+            static constexpr uint8_t MAX_SLOT_CLASS = SLOTS_PER_BUCKET - 1;
+
+            static_assert(MAX_SLOT_CLASS * SLOT_UNIT <= UINT16_MAX, "image length must fit CompressionMap::Entry");
+
+        protected:
+            void collectDirtyMetadataPages(std::vector<const Page*>& pages) override;
+            bool relocateMetadataPage(uint32_t fromPageID, uint32_t toPageID) override;
+
+        private:
+            // Compress and store a heap page; false if it must be written in place instead
+            bool writeCompressed(const Page& page);
+
+            // Drop pageID's compressed image, if any, before it is written in place or freed
+            void dropCompressed(uint32_t pageID);
+
+            CompressionMap::Entry claimSlot(uint8_t slotClass, uint32_t nearPageID);
+
+            // Slot 0 of a new bucket, allocated near nearPageID
+            CompressionMap::Entry openBucket(uint8_t slotClass, uint32_t nearPageID);
+
+            // Returns true if the bucket emptied and its pages were freed
+            bool releaseSlot(const CompressionMap::Entry& entry);
+
+            // Release m_PendingSlots, once the map no longer pointing at them is durable. Returns true
+            // if a bucket was freed, which the free-space map records at the next flush.
+            bool releasePendingSlots();
+
+            // Read the compressed image of an entry into buf (at least entry.length bytes)
+            void readImage(const CompressionMap::Entry& entry, char* buf) const;
+
+            static off_t imageOffset(const CompressionMap::Entry& entry);
+
+            // m_SlotMutex is held shared by reads and exclusive by anything that changes the map or
+            // the slots, taken before m_RecMutex. std::shared_mutex lets a stream of readers starve a
+            // writer, so both go through m_SlotTurnstile: a writer holds it until it has the lock,
+            // and new readers queue behind it.
+            std::shared_lock<std::shared_mutex> lockSlotsShared() const;
+            std::unique_lock<std::shared_mutex> lockSlots();
+
+            mutable std::shared_mutex m_SlotMutex;
+            mutable std::mutex m_SlotTurnstile;
+
+            CompressionMap m_Map;
+
+            // Slots the in-memory map no longer points at, still in use until the next flush
+            std::vector<CompressionMap::Entry> m_PendingSlots;
+
+            // Per slot class: bucket first page -> used-slot mask, and the buckets with a free slot
+            struct SlotClass {
+                std::unordered_map<uint32_t, uint8_t> used;
+                std::set<uint32_t> open;
+            };
+            std::array<SlotClass, MAX_SLOT_CLASS + 1> m_Classes;
+        };
+
+    }
+}
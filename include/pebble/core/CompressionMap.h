@@ -0,0 +1,60 @@
+#pragma once
+
+#include "pebble/core/Page.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // Indirection map for compressed pages, kept in COMPRESSION_MAP pages: one fixed-size entry
+        // per page ID, saying where the page's compressed image lives. The k-th map page in the chain
+        // covers IDs [k * ENTRIES_PER_MAP_PAGE, (k + 1) * ENTRIES_PER_MAP_PAGE); an all-zero entry
+        // (or an ID past the map) means the page is stored uncompressed in its own slot.
+        //
+        // Like FreeSpaceMap the whole map is held in memory and no method here performs I/O.
+        class CompressionMap {
+        public:
+            struct Entry {
+                uint32_t bucketPageID = 0;      // first page of the bucket holding the image
+                uint16_t length = 0;            // compressed bytes
+                uint8_t slotClass = 0;          // slot size in units, 0 = stored uncompressed
+                uint8_t slot = 0;               // index within the bucket
+            };
+            static_assert(sizeof(Entry) == 8, "Entry is stored verbatim in map pages");
+
+            static constexpr uint32_t ENTRIES_PER_MAP_PAGE = PAYLOAD_SIZE / sizeof(Entry);
+
+            // Adopt map pages read from disk, in chain order
+            void load(std::vector<Page> mapPages);
+
+            // First map page of the chain, 0 if the map is empty
+            uint32_t headPageID() const;
+
+            // Can pageID be recorded without adding map pages?
+            bool covers(uint32_t pageID) const;
+
+            // Append an empty map page stored at mapPageID, extending coverage
+            void addMapPage(uint32_t mapPageID);
+
+            Entry get(uint32_t pageID) const;
+            void set(uint32_t pageID, const Entry& entry);
+
+            // Store the map page currently at fromPageID at toPageID instead, false if it is not a map page
+            bool relocateMapPage(uint32_t fromPageID, uint32_t toPageID);
+
+            // Map pages modified since the last call
+            std::vector<const Page*> takeDirtyPages();
+
+            // Visit every compressed page in ID order
+            void forEachCompressed(const std::function<void(uint32_t pageID, const Entry& entry)>& visitor) const;
+
+        private:
+            std::vector<Page> m_MapPages;
+            std::vector<bool> m_Dirty;
+        };
+
+    }
+}
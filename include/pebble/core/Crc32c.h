@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pebble {
+    namespace core {
+
+        // CRC32C (Castagnoli), as used by iSCSI / ext4. Calls chain: crc32c(b, n, crc32c(a, m)) is the
+        // checksum of a followed by b, starting from crc = 0.
+        //
+        // Uses the SSE4.2 / ARMv8 CRC32 instructions when the CPU has them, slicing-by-8 tables otherwise.
+        uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+        // Table-driven implementation, always available (benchmarks / cross-checks)
+        uint32_t crc32cPortable(const void* data, size_t size, uint32_t crc = 0);
+
+        bool crc32cHardwareAccelerated();
+
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "pebble/core/PosixFileManager.h"
+
+#include <atomic>
+#include <string>
+
+namespace pebble {
+    namespace core {
+
+        // PosixFileManager that moves pages with O_DIRECT, bypassing the kernel page cache so pages
+        // cached in the BufferPool are not cached a second time by the OS.
+        // The small meta page write stays on the buffered descriptor.
+        // Falls back to buffered I/O when the filesystem rejects O_DIRECT, either at open()
+        // or on the first page transfer.
+        class DirectFileManager : public PosixFileManager {
+        public:
+            explicit DirectFileManager(const std::string& filename);
+            ~DirectFileManager();
+
+            void readPage(uint32_t pageID, Page& page) override;
+            void writePage(const Page& page) override;
+            void writePages(std::vector<const Page*> pages) override;
+
+            // Readahead would fill the page cache O_DIRECT is meant to bypass
+            void prefetch(std::span<const uint32_t> pageIDs) override {}
+
+            // false when running in the buffered fallback mode
+            bool usingDirectIO() const { return m_Direct.load(std::memory_order_relaxed); }
+
+        private:
+            void disableDirectIO(const char* reason);
+
+            int m_DirectFd = -1;
+            std::atomic<bool> m_Direct{ false };
+        };
+
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "pebble/core/IFileManager.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace pebble {
+    namespace core {
+
+        enum class FileManagerType {
+            POSIX,
+            WINDOWS,
+            IO_URING,
+            MMAP,
+            DIRECT,
+            COMPRESSED
+        };
+
+        // Backend used when none is requested explicitly.
+        FileManagerType defaultFileManagerType();
+
+        // Parse a backend name ("posix", "windows", "io_uring", "mmap", "direct", "compressed"); nullopt if unknown.
+        std::optional<FileManagerType> parseFileManagerType(const std::string& name);
+
+        // Open `filename` with the requested backend.
+        std::unique_ptr<IFileManager> createFileManager(FileManagerType type, const std::string& filename);
+
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace pebble {
+    namespace core {
+
+        // Reader/writer latch over the contents of one buffer frame. A single atomic word (reader
+        // count, or WRITER) taken with one compare-exchange; contended callers block in
+        // std::atomic::wait. Latches are held for one page operation, so there is no writer
+        // preference. Meets the SharedMutex requirements for std::shared_lock / std::unique_lock.
+        class FrameLatch {
+        public:
+            void lock_shared() {
+                uint32_t state = m_State.load(std::memory_order_relaxed);
+                while (true) {
+                    if (state == WRITER) {
+                        m_State.wait(WRITER, std::memory_order_relaxed);
+                        state = m_State.load(std::memory_order_relaxed);
+                    }
+                    else if (m_State.compare_exchange_weak(state, state + 1, std::memory_order_acquire,
+                                                           std::memory_order_relaxed)) {
+                        return;
+                    }
+                }
+            }
+
+            bool try_lock_shared() {
+                uint32_t state = m_State.load(std::memory_order_relaxed);
+                while (state != WRITER) {
+                    if (m_State.compare_exchange_weak(state, state + 1, std::memory_order_acquire,
+                                                      std::memory_order_relaxed))
+                        return true;
+                }
+                return false;
+            }
+
+            void unlock_shared() {
+                if (m_State.fetch_sub(1, std::memory_order_release) == 1)
+                    m_State.notify_all();       // a writer may be waiting for the last reader
+            }
+
+            void lock() {
+                uint32_t state = 0;
+                while (!m_State.compare_exchange_weak(state, WRITER, std::memory_order_acquire,
+                                                      std::memory_order_relaxed)) {
+                    if (state != 0)
+                        m_State.wait(state, std::memory_order_relaxed);
+                    state = 0;
+                }
+            }
+
+            bool try_lock() {
+                uint32_t state = 0;
+                return m_State.compare_exchange_strong(state, WRITER, std::memory_order_acquire,
+                                                       std::memory_order_relaxed);
+            }
+
+            void unlock() {
+                m_State.store(0, std::memory_order_release);
+                m_State.notify_all();
+            }
+
+        private:
+            static constexpr uint32_t WRITER = UINT32_MAX;
+
+            std::atomic<uint32_t> m_State{ 0 };
+        };
+
+    }
+}
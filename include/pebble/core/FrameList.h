@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // Intrusive doubly linked lists over buffer pool frame indices, for replacement policies.
+        // The links live in arrays sized once for the pool, so no operation allocates. A frame is
+        // on at most one of the lists sharing a FrameLinks at a time.
+        class FrameLinks {
+        public:
+            static constexpr uint32_t NONE = UINT32_MAX;
+
+            struct List {
+                uint32_t head = NONE;       // most recent
+                uint32_t tail = NONE;       // least recent
+                size_t size = 0;
+            };
+
+            explicit FrameLinks(size_t capacity)
+                : m_Prev(capacity, NONE), m_Next(capacity, NONE) {
+            }
+
+            void pushFront(List& list, uint32_t frame) {
+                m_Prev[frame] = NONE;
+                m_Next[frame] = list.head;
+                if (list.head != NONE)
+                    m_Prev[list.head] = frame;
+                else
+                    list.tail = frame;
+                list.head = frame;
+                ++list.size;
+            }
+
+            void remove(List& list, uint32_t frame) {
+                uint32_t prev = m_Prev[frame];
+                uint32_t next = m_Next[frame];
+                (prev != NONE ? m_Next[prev] : list.head) = next;
+                (next != NONE ? m_Prev[next] : list.tail) = prev;
+                m_Prev[frame] = m_Next[frame] = NONE;
+                --list.size;
+            }
+
+            void moveToFront(List& list, uint32_t frame) {
+                if (list.head == frame)
+                    return;
+                remove(list, frame);
+                pushFront(list, frame);
+            }
+
+            // Visit the list least recent first until fn returns false; false if it stopped early
+            template <typename Fn>
+            bool forEachFromTail(const List& list, Fn&& fn) const {
+                for (uint32_t frame = list.tail; frame != NONE; frame = m_Prev[frame]) {
+                    if (!fn(frame))
+                        return false;
+                }
+                return true;
+            }
+
+        private:
+            std::vector<uint32_t> m_Prev;       // towards the head
+            std::vector<uint32_t> m_Next;       // towards the tail
+        };
+
+    }
+}
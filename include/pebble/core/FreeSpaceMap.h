@@ -0,0 +1,72 @@
+#pragma once
+
+#include "pebble/core/Page.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // Free-space bitmap kept in FREE_MAP pages, one bit per page ID (set = free).
+        // The k-th map page in the chain covers IDs [k * PAGES_PER_MAP_PAGE, (k + 1) * PAGES_PER_MAP_PAGE),
+        // map pages are linked through PageHeader::m_NextPageID.
+        //
+        // The whole map is held in memory; the owning file manager loads it on open and
+        // writes back dirtyPages() when it flushes. No method here performs I/O.
+        class FreeSpaceMap {
+        public:
+            static constexpr uint32_t WORDS_PER_MAP_PAGE = PAYLOAD_SIZE / sizeof(uint64_t);
+            static constexpr uint32_t PAGES_PER_MAP_PAGE = WORDS_PER_MAP_PAGE * 64;
+
+            // Adopt map pages read from disk, in chain order
+            void load(std::vector<Page> mapPages);
+
+            // First map page of the chain, 0 if the map is empty
+            uint32_t headPageID() const;
+
+            // Can pageID be tracked without adding map pages?
+            bool covers(uint32_t pageID) const;
+
+            // Append an empty map page stored at mapPageID, extending coverage
+            void addMapPage(uint32_t mapPageID);
+
+            void markFree(uint32_t pageID);
+            bool isFree(uint32_t pageID) const;
+
+            // Page IDs from endPageID on no longer exist: clear their free bits
+            void truncate(uint32_t endPageID);
+
+            // Store the map page currently at fromPageID at toPageID instead, false if it is not a map page
+            bool relocateMapPage(uint32_t fromPageID, uint32_t toPageID);
+
+            // Claim `count` consecutive free pages, first fit at or after nearPageID, then from the start.
+            // Returns the first page ID or nullopt if no such run exists.
+            std::optional<uint32_t> allocate(uint32_t count, uint32_t nearPageID);
+
+            uint64_t freePages() const { return m_FreePages; }
+
+            // Map pages modified since the last call
+            std::vector<const Page*> takeDirtyPages();
+
+            // Visit maximal runs of free pages in ID order
+            void forEachFreeRun(const std::function<void(uint32_t first, uint32_t count)>& visitor) const;
+
+        private:
+            std::vector<Page> m_MapPages;
+            std::vector<bool> m_Dirty;
+            uint64_t m_FreePages = 0;
+
+            uint64_t totalBits() const { return static_cast<uint64_t>(m_MapPages.size()) * PAGES_PER_MAP_PAGE; }
+            uint64_t word(uint64_t wordIdx) const;
+            void setWord(uint64_t wordIdx, uint64_t value);
+
+            // First-fit search in [begin, end), returns the first bit of the run
+            std::optional<uint64_t> findRun(uint64_t begin, uint64_t end, uint32_t count) const;
+            void claim(uint64_t first, uint32_t count);
+        };
+
+    }
+}
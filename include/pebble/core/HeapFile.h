@@ -5,6 +5,7 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <functional>
 #include <cstdint>
 
@@ -27,12 +28,23 @@ namespace pebble {
 
             PageID getStartPageID() const; // ✅ Needed for catalog manager
 
+            // Pages of the heap chain, in chain order
+            const std::vector<PageID>& pages() const { return m_Pages; }
+
+            // Relink the chain after BufferPool::movePage() moved some of its pages (old ID -> new ID)
+            void relocate(const std::unordered_map<PageID, PageID>& moved);
+
+            // Record IDs embed the page ID: the ID a record has after relocate()
+            uint64_t relocateRecordID(uint64_t recordID, const std::unordered_map<PageID, PageID>& moved) const;
+
         private:
             std::string m_Name;
             PageID m_StartPageID;
             BufferPool& m_BufferPool;
             std::vector<PageID> m_Pages;
 
+            static constexpr size_t SCAN_PREFETCH_WINDOW = 16;      // pages
+
             uint64_t makeRecordID(PageID pageID, uint16_t slotID) const;
             void parseRecordID(uint64_t recordID, PageID& pageID, uint16_t& slotID) const;
         };
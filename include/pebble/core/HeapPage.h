@@ -4,19 +4,33 @@
 
 #include <functional>
 #include <cstdint>
+#include <type_traits>
 #include <vector>
 #include <string>
 
 namespace pebble {
     namespace core {
 
-        constexpr size_t MAX_SLOTS = 1020;
+        // In-page offsets and lengths: 16 bits while they can address the whole page
+        using SlotOffset = std::conditional_t<(PAGE_SIZE < 65536), uint16_t, uint32_t>;
+
+        // Page layout: [PageHeader][numSlots u16][freeSpaceOffset][Slot...] ... records grow down from the end
+        constexpr size_t HEAP_PAGE_HEADER_SIZE = HEADER_SIZE + sizeof(uint16_t) + sizeof(SlotOffset);
+        constexpr size_t MAX_SLOTS = (PAGE_SIZE - HEAP_PAGE_HEADER_SIZE) / (2 * sizeof(SlotOffset));
+
+        static_assert(MAX_SLOTS <= UINT16_MAX, "slot IDs are 16 bits in record IDs");
 
         class HeapPage
         {
         public:
             explicit HeapPage(Page& page);
 
+            // Read-only view (a page under a ReadPageGuard): only get() and scan() may be used
+            explicit HeapPage(const Page& page);
+
+            // True if insert() of a record this size would succeed
+            bool canInsert(size_t recordSize) const;
+
             // inserts record -> returns slot number or -1 if no space
             int insert(const std::string& record);
 
@@ -30,8 +44,8 @@ namespace pebble {
             Page& m_Page;
 
             struct Slot {
-                uint16_t offset;
-                uint16_t length;
+                SlotOffset offset;
+                SlotOffset length;
             };
 
             uint16_t& numSlots();
@@ -40,10 +54,10 @@ namespace pebble {
             Slot getSlot(uint16_t slotID) const;
             void setSlot(uint16_t slotID, const Slot& slot);
 
-            uint16_t freeSpaceOffset() const;
-            void setFreeSpaceOffset(uint16_t offset);
+            size_t freeSpaceOffset() const;
+            void setFreeSpaceOffset(size_t offset);
 
-            uint16_t headerSize() const;
+            size_t headerSize() const;
         };
     }
 }
\ No newline at end of file
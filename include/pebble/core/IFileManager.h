@@ -2,11 +2,36 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <stdexcept>
 #include "pebble/core/Page.h"
 
 namespace pebble {
     namespace core {
 
+        // Expected access pattern for a range of pages (kernel readahead hint).
+        enum class AccessPattern {
+            NORMAL,
+            SEQUENTIAL,         // heap scans
+            RANDOM              // B+ tree lookups
+        };
+
+        // On-disk compression of a set of pages (e.g. one collection's heap), see compressionStats().
+        struct CompressionStats {
+            uint64_t pages = 0;
+            uint64_t compressedPages = 0;       // stored as compressed images
+            uint64_t logicalBytes = 0;          // pages * PAGE_SIZE
+            uint64_t storedBytes = 0;           // bytes a scan reads back for them
+            double compressMBps = 0;            // codec throughput over these pages
+            double decompressMBps = 0;
+
+            double ratio() const { return storedBytes ? static_cast<double>(logicalBytes) / storedBytes : 1.0; }
+        };
+
         class IFileManager {
         public:
             virtual ~IFileManager() = default;
@@ -17,9 +42,27 @@ namespace pebble {
             // Write a page from memory to disk.
             virtual void writePage(const Page& page) = 0;
 
+            // Write a batch of pages, in page ID order. Backends coalesce adjacent pages into
+            // larger writes; the default writes them one at a time.
+            virtual void writePages(std::vector<const Page*> pages) {
+                sortByPageID(pages);
+                for (const Page* page : pages)
+                    writePage(*page);
+            }
+
             // Allocate a new page and return its pageID.
             virtual uint32_t allocatePage() = 0;
 
+            // Allocate `count` contiguous pages, placed at or after nearPageID when possible.
+            // Returns the first pageID of the run.
+            virtual uint32_t allocatePages(uint32_t count, uint32_t nearPageID) = 0;
+
+            // allocatePages() for pages the caller writes in full before they are ever read back,
+            // such as a buffer pool's new dirty frames: a reused page is not blanked on disk first.
+            virtual uint32_t allocatePagesUnwritten(uint32_t count, uint32_t nearPageID) {
+                return allocatePages(count, nearPageID);
+            }
+
             // Mark a page as free so it can be reused.
             virtual void freePage(uint32_t pageID) = 0;
 
@@ -31,6 +74,59 @@ namespace pebble {
 
             // Print freelist info (mainly for debugging).
             virtual void printFreeList() = 0;
+
+            // ---------------------------------------- [ASYNC I/O] ----------------------------------------
+            // Queue a read/write. The page must stay alive and untouched until waitAll() returns.
+            // Backends without native async I/O complete the request immediately.
+            virtual void readPageAsync(uint32_t pageID, Page& page) { readPage(pageID, page); }
+            virtual void writePageAsync(const Page& page) { writePage(page); }
+
+            // Hand every queued request to the device, returns the number submitted.
+            virtual size_t submit() { return 0; }
+
+            // Block until every submitted request has completed.
+            virtual void waitAll() {}
+
+            // True if the async calls above really overlap I/O.
+            virtual bool supportsAsyncIO() const { return false; }
+
+            // ---------------------------------------- [HINTS] --------------------------------------------
+            // Advise how pages [pageID, pageID + numPages) are about to be accessed. Default: ignored.
+            virtual void adviseAccess(uint32_t pageID, uint32_t numPages, AccessPattern pattern) {}
+
+            // Start reading these pages into the OS cache ahead of use. Default: ignored.
+            virtual void prefetch(std::span<const uint32_t> pageIDs) {}
+
+            // ---------------------------------------- [SPACE] --------------------------------------------
+            // Truncate the file after its last live page, moving the manager's own metadata pages down
+            // into free slots first. Live caller pages are not moved. Returns the number of pages cut
+            // from the file. Default: the file is left as is.
+            virtual uint32_t shrink() { return 0; }
+
+            // ---------------------------------------- [COMPRESSION] --------------------------------------
+            // Footprint and codec throughput for these pages, nullopt if the backend does not compress.
+            virtual std::optional<CompressionStats> compressionStats(std::span<const uint32_t> pageIDs) { return std::nullopt; }
+
+            // ---------------------------------------- [INTEGRITY] ----------------------------------------
+            // Pages read back with a bad checksum since the manager was opened.
+            uint64_t checksumFailures() const { return m_ChecksumFailures.load(std::memory_order_relaxed); }
+
+        protected:
+            // Call on every page read from disk, before its ID is set. Throws on a mismatch.
+            void verifyChecksum(uint32_t pageID, const Page& page) {
+                if (!page.verifyChecksum()) {
+                    m_ChecksumFailures.fetch_add(1, std::memory_order_relaxed);
+                    throw std::runtime_error("Checksum mismatch on page " + std::to_string(pageID));
+                }
+            }
+
+            std::atomic<uint64_t> m_ChecksumFailures{ 0 };
+
+            static void sortByPageID(std::vector<const Page*>& pages) {
+                std::sort(pages.begin(), pages.end(), [](const Page* a, const Page* b) {
+                    return a->getPageID() < b->getPageID();
+                });
+            }
         };
 
     } 
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace pebble {
+    namespace core {
+
+        // Chooses which resident page the BufferPool evicts. The pool reports every event on its
+        // frames, identified by their index in [0, capacity); pins, dirtiness and I/O stay with the
+        // pool, which skips victims it cannot evict. Calls are serialized by the pool's lock.
+        class IReplacementPolicy {
+        public:
+            virtual ~IReplacementPolicy() = default;
+
+            // The page in frame was fetched again.
+            virtual void recordHit(uint32_t frame) = 0;
+
+            // pageID was just loaded into frame. Counts as its first reference; policies that keep
+            // history of evicted pages recognize it by pageID.
+            virtual void recordLoad(uint32_t frame, uint32_t pageID) = 0;
+
+            // The pool evicted the page in frame. Policies may keep history for it.
+            virtual void recordEvict(uint32_t frame) = 0;
+
+            // The page in frame was freed: drop it and any history.
+            virtual void forget(uint32_t frame) = 0;
+
+            // Visit occupied frames in eviction order, best victim first, until fn returns false.
+            virtual void forEachVictim(const std::function<bool(uint32_t frame)>& fn) const = 0;
+
+            virtual const char* name() const = 0;
+        };
+
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "pebble/core/PosixFileManager.h"
+
+#include <linux/io_uring.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // PosixFileManager whose async API is backed by an io_uring instance.
+        // The ring is driven through raw syscalls, no liburing required.
+        // If the kernel refuses io_uring_setup, async calls complete synchronously.
+        class IoUringFileManager : public PosixFileManager {
+        public:
+            explicit IoUringFileManager(const std::string& filename, unsigned queueDepth = 256);
+            ~IoUringFileManager();
+
+            void readPageAsync(uint32_t pageID, Page& page) override;
+            void writePageAsync(const Page& page) override;
+
+            // One IORING_OP_WRITEV per run of consecutive pages, all in flight together
+            void writePages(std::vector<const Page*> pages) override;
+
+            size_t submit() override;
+
+            // Waits for and reports only the requests queued by the calling thread
+            void waitAll() override;
+            bool supportsAsyncIO() const override { return usingIoUring(); }
+
+            // false when running in the synchronous fallback mode
+            bool usingIoUring() const { return m_RingFd >= 0; }
+
+        private:
+            void setupRing(unsigned entries);
+            void teardownRing();
+
+            size_t submitQueued();                   // io_uring_enter for everything prepared, caller holds m_RingMutex
+            io_uring_sqe* nextSqe();                 // free SQE slot, submits / reaps when the ring is full
+            void reap(unsigned minComplete);         // consume CQEs, waiting for at least minComplete
+            uint16_t callerBatch();                  // the calling thread's batch, caller holds m_RingMutex
+
+            // Requests queued by one thread, from the first one until its waitAll(). Every caller
+            // collects its own completions and errors, whoever reaps them.
+            struct Batch {
+                std::thread::id owner;               // default-constructed while the slot is free
+                unsigned outstanding = 0;            // queued or in flight
+                std::vector<std::pair<Page*, uint32_t>> reads;   // verified and given their ID by waitAll()
+                uint32_t failedPageID = 0;
+                bool failed = false;
+            };
+
+            int m_RingFd = -1;
+            unsigned m_QueueDepth = 0;
+
+            // Submission queue
+            void* m_SqRing = nullptr;
+            size_t m_SqRingSize = 0;
+            unsigned* m_SqHead = nullptr;
+            unsigned* m_SqTail = nullptr;
+            unsigned* m_SqMask = nullptr;
+            unsigned* m_SqArray = nullptr;
+            io_uring_sqe* m_Sqes = nullptr;
+            size_t m_SqesSize = 0;
+
+            // Completion queue
+            void* m_CqRing = nullptr;
+            size_t m_CqRingSize = 0;
+            unsigned* m_CqHead = nullptr;
+            unsigned* m_CqTail = nullptr;
+            unsigned* m_CqMask = nullptr;
+            io_uring_cqe* m_Cqes = nullptr;
+
+            unsigned m_Queued = 0;                   // prepared, not yet submitted
+            unsigned m_InFlight = 0;                 // submitted, not yet reaped
+            std::vector<Batch> m_Batches;            // indexed by the batch ID in user_data
+
+            std::mutex m_RingMutex;
+        };
+
+    }
+}
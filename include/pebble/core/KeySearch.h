@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+namespace pebble {
+    namespace core {
+
+        // Search a sorted array of n int keys, as laid out in a B+ tree node (no alignment
+        // assumed). keyLowerBound() is the index of the first key >= key, keyUpperBound() of the
+        // first key > key; both n when there is none.
+        //
+        // A branch-free binary search narrows the range down to a couple of cache lines, whose
+        // keys are then compared all at once: AVX2 when the CPU has it, SSE2 on other x86-64,
+        // scalar elsewhere.
+        int keyLowerBound(const void* keys, int n, int key);
+        int keyUpperBound(const void* keys, int n, int key);
+
+        // Scalar implementation, always available (benchmarks / cross-checks)
+        int keyLowerBoundPortable(const void* keys, int n, int key);
+        int keyUpperBoundPortable(const void* keys, int n, int key);
+
+        // "avx2", "sse2" or "scalar": the compare keyLowerBound() / keyUpperBound() use
+        const char* keySearchInstructionSet();
+
+    }
+}
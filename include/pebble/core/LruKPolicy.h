@@ -0,0 +1,62 @@
+#pragma once
+
+#include "pebble/core/IReplacementPolicy.h"
+
+#include <cstddef>
+#include <deque>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // LRU-K (O'Neil et al.): evict the page whose K-th most recent reference is oldest.
+        // Pages referenced fewer than K times go first, least recently used among them, so a
+        // scan that touches each page once cannot push out pages that are used repeatedly.
+        // History of evicted pages is retained for up to `capacity` pages, so a page that comes
+        // back soon after eviction keeps its earlier references.
+        class LruKPolicy : public IReplacementPolicy {
+        public:
+            explicit LruKPolicy(size_t capacity, unsigned k = 2);
+
+            void recordHit(uint32_t frame) override;
+            void recordLoad(uint32_t frame, uint32_t pageID) override;
+            void recordEvict(uint32_t frame) override;
+            void forget(uint32_t frame) override;
+            void forEachVictim(const std::function<bool(uint32_t frame)>& fn) const override;
+
+            const char* name() const override { return "lru-k"; }
+
+        private:
+            struct Retained {
+                std::vector<uint64_t> times;
+                uint64_t evictedAt = 0;
+            };
+
+            // (has K references, K-th or last reference time, frame): ascending is eviction order
+            using Key = std::tuple<bool, uint64_t, uint32_t>;
+
+            // Reference times of the page in frame, most recent first, 0 = none
+            uint64_t* times(uint32_t frame) { return &m_Times[static_cast<size_t>(frame) * m_K]; }
+            const uint64_t* times(uint32_t frame) const { return &m_Times[static_cast<size_t>(frame) * m_K]; }
+
+            Key key(uint32_t frame) const;
+            void reference(uint32_t frame);
+
+            unsigned m_K;
+            size_t m_RetainedMax;
+            uint64_t m_Clock = 0;
+
+            std::vector<uint64_t> m_Times;                              // K per frame
+            std::vector<uint32_t> m_PageIDs;                            // page in each frame
+            std::vector<bool> m_Resident;
+            std::set<Key> m_Order;                                      // occupied frames only
+
+            std::unordered_map<uint32_t, Retained> m_Retained;          // evicted pages by ID
+            std::deque<std::pair<uint32_t, uint64_t>> m_RetainedOrder;  // (pageID, evictedAt), oldest first
+        };
+
+    }
+}
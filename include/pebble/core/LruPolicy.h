@@ -0,0 +1,32 @@
+#pragma once
+
+#include "pebble/core/IReplacementPolicy.h"
+#include "pebble/core/FrameList.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // Least recently used. Every operation is O(1) and none allocates.
+        class LruPolicy : public IReplacementPolicy {
+        public:
+            explicit LruPolicy(size_t capacity);
+
+            void recordHit(uint32_t frame) override;
+            void recordLoad(uint32_t frame, uint32_t pageID) override;
+            void recordEvict(uint32_t frame) override { forget(frame); }
+            void forget(uint32_t frame) override;
+            void forEachVictim(const std::function<bool(uint32_t frame)>& fn) const override;
+
+            const char* name() const override { return "lru"; }
+
+        private:
+            FrameLinks m_Links;
+            FrameLinks::List m_List;
+            std::vector<bool> m_Resident;
+        };
+
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+namespace pebble {
+    namespace core {
+
+        // Byte-oriented LZ77 codec in the style of the LZ4 block format: sequences of
+        // [token][literal length ext][literals][2-byte offset][match length ext].
+        // Tuned for page-sized inputs (offsets fit 16 bits); no framing, no checksum.
+
+        // Compress src into dst. Returns the compressed size, or 0 if it would exceed dstCapacity.
+        size_t lzCompress(const char* src, size_t srcSize, char* dst, size_t dstCapacity);
+
+        // Decompress src into dst. Returns the decompressed size, or 0 if the input is malformed
+        // or does not fit in dstCapacity.
+        size_t lzDecompress(const char* src, size_t srcSize, char* dst, size_t dstCapacity);
+
+    }
+}
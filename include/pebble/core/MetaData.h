@@ -1,24 +1,53 @@
 #pragma once
 
+#include "pebble/core/Page.h"
+
 #include <cstdint>
+#include <stdexcept>
+#include <string>
 
 namespace pebble {
     namespace core {
 
         struct MetaData {
             PageID m_NextPageID;     // Next page ID to allocate if freelist is empty
-            PageID m_FreeListHead;   // PageID of the head of the freelist
+            PageID m_FreeListHead;   // PageID of the head of the freelist, WindowsFileManager only
             PageID m_CatalogRootPageID;     // (optional) root of B+ tree
             PageID m_Reserved;       // reserved for future (e.g., transaction ID)
+            PageID m_FreeMapPageID;  // first page of the free-space bitmap, 0 if none
+            PageID m_CompressionMapPageID;  // first page of the compressed-page map, 0 if none
+            uint32_t m_PageSize;     // PAGE_SIZE of the build that created the file
+            uint32_t m_FormatVersion;       // FORMAT_VERSION of the file, 0 in files from before it was recorded
+
+            // On-disk page layout. Files of another version are refused, never converted: bump this
+            // on any change older builds cannot read.
+            //   1: 16-byte PageHeader with a CRC32C checksum, free-space bitmap, page size in MetaData,
+            //      B+ tree order stored at node payload offset 0.
+            //      Files written before it (12-byte header, freelist chain) cannot be opened.
+            static constexpr uint32_t FORMAT_VERSION = 1;
 
             MetaData()
-                : m_NextPageID(1), m_FreeListHead(0), m_CatalogRootPageID(1), m_Reserved(0)
+                : m_NextPageID(1), m_FreeListHead(0), m_CatalogRootPageID(1), m_Reserved(0), m_FreeMapPageID(0),
+                m_CompressionMapPageID(0), m_PageSize(PAGE_SIZE), m_FormatVersion(FORMAT_VERSION)
             {}
 
-            MetaData(PageID nextPageID, PageID freeListHead)
+            MetaData(PageID nextPageID, PageID freeListHead, PageID freeMapPageID = 0, PageID compressionMapPageID = 0)
                 : m_NextPageID(nextPageID), m_FreeListHead(freeListHead),
-                m_CatalogRootPageID(1), m_Reserved(0)
+                m_CatalogRootPageID(1), m_Reserved(0), m_FreeMapPageID(freeMapPageID),
+                m_CompressionMapPageID(compressionMapPageID), m_PageSize(PAGE_SIZE), m_FormatVersion(FORMAT_VERSION)
             {}
+
+            // Throws unless this build can read the file the MetaData was loaded from
+            void checkCompatible(const std::string& filename) const {
+                if (m_FormatVersion != FORMAT_VERSION) {
+                    throw std::runtime_error(filename + " has on-disk format " + std::to_string(m_FormatVersion) +
+                                             ", this build reads format " + std::to_string(FORMAT_VERSION));
+                }
+                if (m_PageSize != PAGE_SIZE) {
+                    throw std::runtime_error(filename + " uses " + std::to_string(m_PageSize) +
+                                             "-byte pages, this build uses " + std::to_string(PAGE_SIZE));
+                }
+            }
         };
 
     }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "pebble/core/PosixFileManager.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace pebble {
+    namespace core {
+
+        // PosixFileManager whose read path is served from a shared, read-only mapping of the file:
+        // a miss costs one copy out of the page cache and no syscall. Writes still go through
+        // pwrite; the kernel page cache keeps both views coherent. Buffer frames are modified in
+        // place under their guards, so they stay copies rather than aliases of the mapping.
+        //
+        // The mapping lives inside an address range reserved up front, and grows in place as the
+        // file grows, so readers never see it move and need no lock. shrink() returns the part
+        // past the new end of file to the reservation.
+        class MmapFileManager : public PosixFileManager {
+        public:
+            explicit MmapFileManager(const std::string& filename, size_t maxMappedBytes = DEFAULT_RESERVATION);
+            ~MmapFileManager();
+
+            void readPage(uint32_t pageID, Page& page) override;
+            uint32_t allocatePages(uint32_t count, uint32_t nearPageID) override;
+            uint32_t allocatePagesUnwritten(uint32_t count, uint32_t nearPageID) override;
+            uint32_t shrink() override;
+
+            void adviseAccess(uint32_t pageID, uint32_t numPages, AccessPattern pattern) override;
+            void prefetch(std::span<const uint32_t> pageIDs) override;
+
+            size_t mappedBytes() const { return m_MappedBytes.load(std::memory_order_acquire); }
+
+            static constexpr size_t DEFAULT_RESERVATION = size_t(64) << 30;    // 64 GiB of address space
+
+        private:
+            // Extend the mapping to cover the current file size, returns false if pageID is still unmapped
+            bool growMapping(uint32_t pageID);
+            bool isMapped(uint32_t pageID) const;
+
+            char* m_Base = nullptr;
+            size_t m_Reserved = 0;
+            size_t m_OsPageSize = 0;
+
+            // Only lowered by shrink(), past pages that are no longer allocated, so readers of
+            // live pages that see them as mapped can use them without locking
+            std::atomic<size_t> m_MappedBytes{ 0 };
+            std::mutex m_GrowMutex;
+        };
+
+    }
+}
@@ -1,13 +1,22 @@
 #pragma once
 
 #include <cstdint>
-#include <array>
 #include <cstring>
+#include <memory>
 
 namespace pebble {
     namespace core
     {
-        constexpr size_t PAGE_SIZE = 4096;
+#ifndef PEBBLE_PAGE_SIZE
+#define PEBBLE_PAGE_SIZE 4096
+#endif
+
+        // Build setting (CMake PEBBLE_PAGE_SIZE): 4 KiB for OLTP, up to 64 KiB for scan-heavy databases
+        constexpr size_t PAGE_SIZE = PEBBLE_PAGE_SIZE;
+        constexpr size_t PAGE_ALIGNMENT = 4096;     // page buffers satisfy O_DIRECT / sector alignment
+
+        static_assert(PAGE_SIZE >= 4096 && PAGE_SIZE <= 65536 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+                      "PEBBLE_PAGE_SIZE must be a power of two between 4 KiB and 64 KiB");
 
         using PageID = uint32_t;
 
@@ -18,13 +27,16 @@ namespace pebble {
             META = 3,
             CATALOG = 4,
             FREE = 5,
-            HEAP = 6
+            HEAP = 6,
+            FREE_MAP = 7,
+            COMPRESSION_MAP = 8
         };
 
         struct PageHeader {
             PageType m_Type;
             uint32_t m_PageID;
             uint32_t m_NextPageID;
+            uint32_t m_Checksum;        // CRC32C of the page with this field zeroed, stamped on write
         };
 
 
@@ -35,6 +47,16 @@ namespace pebble {
         public:
             Page();
 
+            // View over a caller-owned buffer of PAGE_SIZE bytes, PAGE_ALIGNMENT aligned, that
+            // outlives the page (buffer pool frames). The contents are left as they are.
+            explicit Page(char* buffer);
+
+            // copies duplicate the buffer, moves hand it over
+            Page(const Page& other);
+            Page& operator=(const Page& other);
+            Page(Page&& other) noexcept = default;
+            Page& operator=(Page&& other) noexcept = default;
+
             void setPageID(uint32_t id);
             uint32_t getPageID() const;
 
@@ -52,8 +74,22 @@ namespace pebble {
 
             void clear();
 
+            // The checksum is derived from the contents, not part of them: stamping is allowed on a
+            // const page and only ever done by a file manager right before the page is written.
+            uint32_t computeChecksum() const;
+            void stampChecksum() const;
+
+            // True if the stored checksum matches, or the page was never written (all zeros)
+            bool verifyChecksum() const;
+
         private:
-            std::array<char, PAGE_SIZE> m_Buffer;
+            struct AlignedDelete {
+                bool owned;         // false for a caller-owned buffer
+                void operator()(char* p) const;
+            };
+
+            // heap allocated so the alignment holds wherever the Page itself lives
+            std::unique_ptr<char[], AlignedDelete> m_Buffer;
         };
 
     }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace pebble {
+    namespace core {
+
+        // How a PageArena's memory is backed. Requesting a mode falls back down the list when the
+        // system cannot provide it, the arena reports what it got.
+        enum class HugePageMode {
+            NONE,           // regular pages
+            TRANSPARENT,    // madvise(MADV_HUGEPAGE): the kernel backs it with huge pages where it can
+            HUGETLB         // MAP_HUGETLB: reserved huge pages (vm.nr_hugepages), else TRANSPARENT
+        };
+
+        // Parse a mode name ("none", "transparent", "hugetlb"); nullopt if unknown.
+        std::optional<HugePageMode> parseHugePageMode(const std::string& name);
+
+        const char* hugePageModeName(HugePageMode mode);
+
+        // One contiguous allocation of `pages` page buffers of PAGE_SIZE bytes, PAGE_ALIGNMENT
+        // aligned, for a buffer pool's frames. Memory is committed as pages are first written.
+        // Huge pages cut the TLB misses of random accesses over a pool of many GB; they are Linux
+        // only, elsewhere every mode gives NONE.
+        class PageArena {
+        public:
+            PageArena(size_t pages, HugePageMode mode);
+            ~PageArena();
+
+            PageArena(const PageArena&) = delete;
+            PageArena& operator=(const PageArena&) = delete;
+
+            char* page(size_t i) const;
+
+            // Give the memory of pages [first, first + count) back to the system, they read as
+            // zeros when next used. Best effort: whole system pages only, and nothing of HUGETLB
+            // memory, which stays reserved to the arena.
+            void release(size_t first, size_t count);
+
+            // The mode in effect, after fallbacks
+            HugePageMode mode() const { return m_Mode; }
+
+        private:
+            char* m_Data = nullptr;
+            size_t m_MappedBytes = 0;       // 0: allocated with operator new
+            HugePageMode m_Mode = HugePageMode::NONE;
+        };
+
+    }
+}
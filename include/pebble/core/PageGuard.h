@@ -0,0 +1,72 @@
+#pragma once
+
+#include "pebble/core/Page.h"
+
+namespace pebble {
+    namespace core {
+
+        struct Frame;
+
+        // Move-only handle on a pinned buffer pool page, holding the frame's latch in shared mode.
+        // Destroying it (or release()) unlatches and unpins without touching the pool's latches.
+        class ReadPageGuard {
+        public:
+            ReadPageGuard() = default;
+            ~ReadPageGuard();
+
+            ReadPageGuard(ReadPageGuard&& other) noexcept;
+            ReadPageGuard& operator=(ReadPageGuard&& other) noexcept;
+            ReadPageGuard(const ReadPageGuard&) = delete;
+            ReadPageGuard& operator=(const ReadPageGuard&) = delete;
+
+            const Page& page() const { return *m_Page; }
+            PageID pageID() const { return m_Page->getPageID(); }
+
+            explicit operator bool() const { return m_Frame != nullptr; }
+
+            // Give up the latch and the pin early
+            void release();
+
+        private:
+            friend class BufferPool;
+
+            // frame is pinned by the caller, the guard takes over that pin
+            explicit ReadPageGuard(Frame& frame);
+
+            Frame* m_Frame = nullptr;
+            const Page* m_Page = nullptr;
+        };
+
+        // As ReadPageGuard, with the latch held exclusively. Any mutable access to the page marks it
+        // dirty when the guard lets go.
+        class WritePageGuard {
+        public:
+            WritePageGuard() = default;
+            ~WritePageGuard();
+
+            WritePageGuard(WritePageGuard&& other) noexcept;
+            WritePageGuard& operator=(WritePageGuard&& other) noexcept;
+            WritePageGuard(const WritePageGuard&) = delete;
+            WritePageGuard& operator=(const WritePageGuard&) = delete;
+
+            Page& page() { m_Dirty = true; return *m_Page; }
+            const Page& page() const { return *m_Page; }
+            PageID pageID() const { return m_Page->getPageID(); }
+
+            explicit operator bool() const { return m_Frame != nullptr; }
+
+            // Give up the latch and the pin early
+            void release();
+
+        private:
+            friend class BufferPool;
+
+            explicit WritePageGuard(Frame& frame);
+
+            Frame* m_Frame = nullptr;
+            Page* m_Page = nullptr;
+            bool m_Dirty = false;
+        };
+
+    }
+}
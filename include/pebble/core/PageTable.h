@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // Page ID -> frame index map of a buffer pool. Open addressing with linear probing over a
+        // power-of-two slot array sized once for the pool (at most half full), deletion by
+        // backward shift so no tombstones build up. Each slot is a single 64-bit word holding
+        // both IDs; nothing allocates after construction. Not synchronized: the pool's latch
+        // covers it, and lookups touch one or two cache lines, so that critical section stays short.
+        class PageTable {
+        public:
+            static constexpr uint32_t NO_FRAME = UINT32_MAX;
+
+            explicit PageTable(size_t frames);
+
+            // Frame holding pageID, or NO_FRAME
+            uint32_t find(uint32_t pageID) const;
+
+            // pageID must not be present
+            void insert(uint32_t pageID, uint32_t frame);
+
+            void erase(uint32_t pageID);
+
+            size_t size() const { return m_Size; }
+
+        private:
+            static constexpr uint64_t EMPTY = UINT64_MAX;      // page ID UINT32_MAX is never valid
+
+            static uint32_t pageOf(uint64_t slot) { return static_cast<uint32_t>(slot >> 32); }
+            static uint32_t frameOf(uint64_t slot) { return static_cast<uint32_t>(slot); }
+
+            // Fibonacci hashing: consecutive page IDs spread over the whole table
+            size_t home(uint32_t pageID) const {
+                return static_cast<size_t>((pageID * 0x9E3779B97F4A7C15ull) >> m_Shift);
+            }
+
+            std::vector<uint64_t> m_Slots;      // (pageID << 32) | frame, or EMPTY
+            size_t m_Mask;
+            unsigned m_Shift;
+            size_t m_Size = 0;
+        };
+
+    }
+}
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "pebble/core/IFileManager.h"
+#include "pebble/core/FreeSpaceMap.h"
 
 #include <string>
+#include <set>
 #include <mutex>
+#include <functional>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -21,24 +24,76 @@ namespace pebble {
 
             void readPage(uint32_t pageID, Page& page) override;
             void writePage(const Page& page) override;
+            void writePages(std::vector<const Page*> pages) override;
 
             uint32_t allocatePage() override;
+            uint32_t allocatePages(uint32_t count, uint32_t nearPageID) override;
+            uint32_t allocatePagesUnwritten(uint32_t count, uint32_t nearPageID) override;
             void freePage(uint32_t pageID) override;
 
             void flush() override;
+            uint32_t shrink() override;
 
             bool pageExists(uint32_t pageID) const override;
             void printFreeList() override;
 
-        private:
+            void adviseAccess(uint32_t pageID, uint32_t numPages, AccessPattern pattern) override;
+            void prefetch(std::span<const uint32_t> pageIDs) override;
+
+        protected:
+            // pageCompression: the subclass understands compressed page images. Without it, files
+            // that contain compressed pages are refused instead of read back as holes.
+            PosixFileManager(const std::string& filename, bool pageCompression);
+
             void loadMetaPage();
             void updateMetaPage();
 
+            // Subclasses append dirty pages of their own on-disk structures, written before MetaData
+            virtual void collectDirtyMetadataPages(std::vector<const Page*>& pages) {}
+
+            // Move a metadata page the manager owns from fromPageID to the free page toPageID.
+            // Returns false if fromPageID is not one of them. Subclasses chain to the base.
+            virtual bool relocateMetadataPage(uint32_t fromPageID, uint32_t toPageID);
+
+            // Deallocate the disk blocks behind m_PendingHoles. Only call once the free-space map
+            // (and any map pointing away from those pages) is durable.
+            void punchPendingHoles();
+
+            // Read the free-space map chain
+            void loadFreeSpaceMap(uint32_t mapHeadPageID);
+
+            // allocatePages(), blanking reused pages on disk or not
+            uint32_t allocate(uint32_t count, uint32_t nearPageID, bool blankReused);
+
+            // Fresh pages from the end of the file
+            uint32_t allocateFromExtent(uint32_t count);
+
+            // Extend the file with a zero-filled extent that covers pageID
+            void reserveExtent(uint32_t pageID);
+
+            // Call fn(first, count) for each run of consecutive IDs in pageIDs (sorted copy)
+            static void forEachRun(std::span<const uint32_t> pageIDs, const std::function<void(uint32_t, uint32_t)>& fn);
+
+            // Sort pages and write each run of consecutive page IDs with one pwritev on fd.
+            // Returns 0, or the errno of the first failed write.
+            int writePageRuns(int fd, std::vector<const Page*>& pages);
+
+            static constexpr size_t MAX_IOVECS = 1024;          // IOV_MAX on Linux
+
             int m_Fd;                  // POSIX file descriptor
             std::string m_Filename;
 
             uint32_t m_NextPageID = 1;  // from meta page
-            uint32_t m_FreeListHead = 0;
+            FreeSpaceMap m_FreeSpaceMap;
+            uint32_t m_CompressionMapPageID = 0;    // persisted in MetaData, owned by the subclass
+            uint32_t m_ExtentEnd = 0;   // pages below this are backed by the file
+
+            // Freed pages whose blocks are released after the next flush, unless reused first
+            std::set<uint32_t> m_PendingHoles;
+
+            // Extent size grows with the file: 1/8th of it, clamped to [MIN, MAX]
+            static constexpr uint32_t MIN_EXTENT_PAGES = (size_t(256) << 10) / PAGE_SIZE;   // 256 KiB
+            static constexpr uint32_t MAX_EXTENT_PAGES = (size_t(64) << 20) / PAGE_SIZE;    // 64 MiB
 
             mutable std::recursive_mutex m_RecMutex;
 
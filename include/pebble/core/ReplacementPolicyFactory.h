@@ -0,0 +1,27 @@
+#pragma once
+
+#include "pebble/core/IReplacementPolicy.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace pebble {
+    namespace core {
+
+        enum class ReplacementPolicyType {
+            LRU,
+            LRU_K,          // LRU-2
+            TWO_Q,
+            ARC
+        };
+
+        // Parse a policy name ("lru", "lru-k", "2q", "arc"); nullopt if unknown.
+        std::optional<ReplacementPolicyType> parseReplacementPolicyType(const std::string& name);
+
+        // Policy for a pool of `capacity` frames.
+        std::unique_ptr<IReplacementPolicy> createReplacementPolicy(ReplacementPolicyType type, size_t capacity);
+
+    }
+}
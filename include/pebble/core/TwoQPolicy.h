@@ -0,0 +1,50 @@
+#pragma once
+
+#include "pebble/core/IReplacementPolicy.h"
+#include "pebble/core/FrameList.h"
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace pebble {
+    namespace core {
+
+        // Full 2Q (Johnson & Shasha). New pages enter the A1in FIFO; only pages referenced again
+        // after leaving it (while still remembered in the A1out ghost queue) are promoted to the
+        // Am LRU. A scan passes through A1in and never displaces Am.
+        // A1in targets 1/4 of the pool, A1out remembers 1/2 of the pool's worth of page IDs.
+        class TwoQPolicy : public IReplacementPolicy {
+        public:
+            explicit TwoQPolicy(size_t capacity);
+
+            void recordHit(uint32_t frame) override;
+            void recordLoad(uint32_t frame, uint32_t pageID) override;
+            void recordEvict(uint32_t frame) override;
+            void forget(uint32_t frame) override;
+            void forEachVictim(const std::function<bool(uint32_t frame)>& fn) const override;
+
+            const char* name() const override { return "2q"; }
+
+        private:
+            enum class Queue : uint8_t { NONE, IN, MAIN };
+
+            void unlink(uint32_t frame);
+
+            size_t m_InTarget;
+            size_t m_OutMax;
+
+            FrameLinks m_Links;
+            FrameLinks::List m_In;              // A1in: FIFO, newest at head
+            FrameLinks::List m_Main;            // Am: most recent at head
+            std::vector<Queue> m_Queue;         // per frame
+            std::vector<uint32_t> m_PageIDs;    // per frame
+
+            // A1out: evicted from A1in, page IDs only, newest at front
+            std::list<uint32_t> m_Out;
+            std::unordered_map<uint32_t, std::list<uint32_t>::iterator> m_OutPos;
+        };
+
+    }
+}
@@ -18,6 +18,7 @@ namespace pebble {
             void writePage(const Page& page) override;
 
             uint32_t allocatePage() override;
+            uint32_t allocatePages(uint32_t count, uint32_t nearPageID) override;
             void freePage(uint32_t pageID) override;
 
             void flush() override;
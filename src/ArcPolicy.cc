@@ -0,0 +1,120 @@
+#include "pebble/core/ArcPolicy.h"
+
+#include <algorithm>
+
+using namespace pebble::core;
+
+ArcPolicy::ArcPolicy(size_t capacity)
+    : m_Capacity(std::max<size_t>(1, capacity)),
+      m_Links(capacity),
+      m_Queue(capacity, Queue::NONE),
+      m_PageIDs(capacity, 0)
+{}
+
+void ArcPolicy::unlink(uint32_t frame)
+{
+    if (m_Queue[frame] == Queue::NONE)
+        return;
+
+    m_Links.remove(resident(m_Queue[frame]), frame);
+    m_Queue[frame] = Queue::NONE;
+}
+
+void ArcPolicy::admit(Queue queue, uint32_t frame)
+{
+    unlink(frame);
+    m_Links.pushFront(resident(queue), frame);
+    m_Queue[frame] = queue;
+}
+
+void ArcPolicy::addGhost(Queue queue, uint32_t pageID)
+{
+    std::list<uint32_t>& list = ghosts(queue);
+    list.push_front(pageID);
+    m_Ghosts[pageID] = { queue, list.begin() };
+}
+
+void ArcPolicy::dropLru(Queue queue)
+{
+    std::list<uint32_t>& list = ghosts(queue);
+    if (list.empty())
+        return;
+
+    m_Ghosts.erase(list.back());
+    list.pop_back();
+}
+
+// Directory bounds from the paper: |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c
+void ArcPolicy::trimGhosts()
+{
+    while (m_T1.size + m_B1.size() > m_Capacity && !m_B1.empty())
+        dropLru(Queue::B1);
+
+    while (directorySize() > 2 * m_Capacity && !(m_B1.empty() && m_B2.empty()))
+        dropLru(m_B2.empty() ? Queue::B1 : Queue::B2);
+}
+
+void ArcPolicy::recordHit(uint32_t frame)
+{
+    if (m_Queue[frame] != Queue::NONE)
+        admit(Queue::T2, frame);
+}
+
+void ArcPolicy::recordLoad(uint32_t frame, uint32_t pageID)
+{
+    unlink(frame);
+    m_PageIDs[frame] = pageID;
+
+    auto it = m_Ghosts.find(pageID);
+    if (it != m_Ghosts.end()) {
+        // Ghost hit: grow the side of the cache that would have kept the page
+        if (it->second.queue == Queue::B1) {
+            size_t delta = std::max<size_t>(1, m_B2.size() / m_B1.size());
+            m_Target = std::min(m_Capacity, m_Target + delta);
+        }
+        else {
+            size_t delta = std::max<size_t>(1, m_B1.size() / m_B2.size());
+            m_Target = m_Target > delta ? m_Target - delta : 0;
+        }
+
+        ghosts(it->second.queue).erase(it->second.pos);
+        m_Ghosts.erase(it);
+        admit(Queue::T2, frame);
+        return;
+    }
+
+    // A page not seen recently: make room in the directory, then admit it to T1
+    if (m_T1.size + m_B1.size() >= m_Capacity)
+        dropLru(Queue::B1);
+    else if (directorySize() >= 2 * m_Capacity)
+        dropLru(Queue::B2);
+
+    admit(Queue::T1, frame);
+}
+
+void ArcPolicy::recordEvict(uint32_t frame)
+{
+    Queue queue = m_Queue[frame];
+    if (queue == Queue::NONE)
+        return;
+
+    unlink(frame);
+    addGhost(queue == Queue::T1 ? Queue::B1 : Queue::B2, m_PageIDs[frame]);
+    trimGhosts();
+}
+
+void ArcPolicy::forget(uint32_t frame)
+{
+    unlink(frame);
+}
+
+void ArcPolicy::forEachVictim(const std::function<bool(uint32_t frame)>& fn) const
+{
+    // REPLACE: take from T1 while it is above its target, otherwise from T2
+    bool fromT1 = m_T1.size != 0 && (m_T1.size > m_Target || m_T2.size == 0);
+    const FrameLinks::List& first = fromT1 ? m_T1 : m_T2;
+    const FrameLinks::List& second = fromT1 ? m_T2 : m_T1;
+
+    if (m_Links.forEachFromTail(first, fn))
+        m_Links.forEachFromTail(second, fn);
+}
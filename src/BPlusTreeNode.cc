@@ -1,4 +1,5 @@
 #include "pebble/core/BPlusTreeNode.h"
+#include "pebble/core/KeySearch.h"
 #include <cstring>
 #include <stdexcept>
 
@@ -8,6 +9,10 @@ BPlusTreeNode::BPlusTreeNode(Page& page)
     : m_Page(page) {
 }
 
+BPlusTreeNode::BPlusTreeNode(const Page& page)
+    : m_Page(const_cast<Page&>(page)) {
+}
+
 bool BPlusTreeNode::isLeaf() const {
     return m_Page.header()->m_Type == PageType::LEAF;
 }
@@ -16,6 +21,14 @@ void BPlusTreeNode::setLeaf(bool leaf) {
     m_Page.header()->m_Type = leaf ? PageType::LEAF : PageType::INTERNAL;
 }
 
+int BPlusTreeNode::getOrder() const {
+    return *reinterpret_cast<const uint16_t*>(m_Page.payload() + NODE_ORDER_OFFSET);
+}
+
+void BPlusTreeNode::setOrder(int order) {
+    *reinterpret_cast<uint16_t*>(m_Page.payload() + NODE_ORDER_OFFSET) = static_cast<uint16_t>(order);
+}
+
 int BPlusTreeNode::getNumKeys() const {
     return *reinterpret_cast<const uint16_t*>(m_Page.payload() + NODE_NUM_KEYS_OFFSET);
 }
@@ -123,18 +136,21 @@ void BPlusTreeNode::setNextLeaf(uint32_t pageID) {
     *reinterpret_cast<uint32_t*>(m_Page.payload() + NODE_NEXT_LEAF_OFFSET) = pageID;
 }
 
+int BPlusTreeNode::lowerBound(int key) const {
+    return keyLowerBound(m_Page.payload() + keyOffset(), getNumKeys(), key);
+}
+
+int BPlusTreeNode::upperBound(int key) const {
+    return keyUpperBound(m_Page.payload() + keyOffset(), getNumKeys(), key);
+}
+
 int BPlusTreeNode::findKeyIndex(int key) const {
-    for (int i = 0; i < getNumKeys(); ++i)
-        if (getKey(i) == key) return i;
-    return -1;
+    int i = lowerBound(key);
+    return i < getNumKeys() && getKey(i) == key ? i : -1;
 }
 
 int BPlusTreeNode::findChildIndex(int key) const {
-    int i = 0;
-    while (i < getNumKeys() && key >= getKey(i)) {
-        ++i;
-    }
-    return i; // returns index of child to follow
+    return upperBound(key); // returns index of child to follow
 }
 
 
@@ -14,9 +14,9 @@ bool BPlusTree::insert(int key, uint64_t value) {
     insertInternal(key, value, m_RootPageID, promotedKey, newChildPageID);
 
     if (newChildPageID != 0) {
-        PageID newRootID = m_BufferPool.allocatePage();
-        Page& newRootPage = m_BufferPool.fetchPage(newRootID);
-        BPlusTreeNode newRoot(newRootPage);
+        WritePageGuard guard = allocateNode();
+        PageID newRootID = guard.pageID();
+        BPlusTreeNode newRoot(guard.page());
 
         newRoot.setLeaf(false);
         newRoot.setNumKeys(1);
@@ -24,9 +24,6 @@ bool BPlusTree::insert(int key, uint64_t value) {
         newRoot.setChild(0, m_RootPageID);
         newRoot.setChild(1, newChildPageID);
 
-        m_BufferPool.markDirty(newRootID);
-        m_BufferPool.unpinPage(newRootID);
-
         m_RootPageID = newRootID;
         return true;
     }
@@ -38,16 +35,14 @@ void BPlusTree::insertInternal(
     PageID pageID,
     int& promotedKey, PageID& newChildPageID
 ) {
-    Page& page = m_BufferPool.fetchPage(pageID);
-    BPlusTreeNode node(page);
+    WritePageGuard guard = m_BufferPool.fetchPageWrite(pageID);
+    BPlusTreeNode node(guard.page());
 
     int n = node.getNumKeys();
-    int idx = 0;
-    while (idx < n && node.getKey(idx) < key)
-        idx++;
 
     if (node.isLeaf()) 
     {
+        int idx = node.lowerBound(key);
         node.insertKeyAt(idx, key);
         node.insertValueAt(idx, value);
         node.setNumKeys(n + 1);
@@ -58,6 +53,8 @@ void BPlusTree::insertInternal(
             newChildPageID = 0;
         }
     } else {
+        // Same descent as search and remove: a key equal to a separator goes right
+        int idx = node.findChildIndex(key);
         PageID childID = node.getChild(idx);
         int childPromotedKey = -1;
         PageID childNewPageID = 0;
@@ -79,9 +76,14 @@ void BPlusTree::insertInternal(
             newChildPageID = 0;
         }
     }
+}
 
-    m_BufferPool.markDirty(pageID);
-    m_BufferPool.unpinPage(pageID);
+WritePageGuard BPlusTree::allocateNode(PageID nearPageID)
+{
+    WritePageGuard guard = m_BufferPool.newPage(nearPageID);
+    m_BufferPool.adviseAccess(guard.pageID(), 1, AccessPattern::RANDOM);
+    BPlusTreeNode(guard.page()).setOrder(m_Order);
+    return guard;
 }
 
 void BPlusTree::splitLeaf(BPlusTreeNode& node, PageID pageID,
@@ -89,9 +91,9 @@ void BPlusTree::splitLeaf(BPlusTreeNode& node, PageID pageID,
     int total = node.getNumKeys();
     int mid = total / 2;
 
-    newLeafPageID = m_BufferPool.allocatePage();
-    Page& siblingPage = m_BufferPool.fetchPage(newLeafPageID);
-    BPlusTreeNode sibling(siblingPage);
+    WritePageGuard guard = allocateNode(pageID);
+    newLeafPageID = guard.pageID();
+    BPlusTreeNode sibling(guard.page());
     sibling.setLeaf(true);
 
     // Move second half to sibling
@@ -107,11 +109,6 @@ void BPlusTree::splitLeaf(BPlusTreeNode& node, PageID pageID,
     sibling.setNextLeaf(node.getNextLeaf());
     node.setNextLeaf(newLeafPageID);
 
-    m_BufferPool.markDirty(pageID);
-
-    m_BufferPool.markDirty(newLeafPageID);
-    m_BufferPool.unpinPage(newLeafPageID);
-
     newKey = sibling.getKey(0);  // First key in sibling is promoted
 }
 
@@ -121,9 +118,9 @@ void BPlusTree::splitInternal(BPlusTreeNode& node, PageID pageID,
     int mid = total / 2;
     newKey = node.getKey(mid);
 
-    newPageID = m_BufferPool.allocatePage();
-    Page& siblingPage = m_BufferPool.fetchPage(newPageID);
-    BPlusTreeNode sibling(siblingPage);
+    WritePageGuard guard = allocateNode(pageID);
+    newPageID = guard.pageID();
+    BPlusTreeNode sibling(guard.page());
     sibling.setLeaf(false);
 
     int rightKeys = total - mid - 1;
@@ -136,9 +133,4 @@ void BPlusTree::splitInternal(BPlusTreeNode& node, PageID pageID,
     sibling.setChild(rightKeys, node.getChild(total));
 
     node.setNumKeys(mid);
-
-    m_BufferPool.markDirty(pageID);
-
-    m_BufferPool.markDirty(newPageID);
-    m_BufferPool.unpinPage(newPageID);
 }
@@ -1,6 +1,6 @@
 #include "pebble/core/BPlusTree.h"
 
-#include <queue>
+#include <vector>
 #include <iostream>
 
 using namespace pebble::core;
@@ -11,22 +11,21 @@ void BPlusTree::print() {
         return;
     }
 
-    std::queue<PageID> q;
-    q.push(m_RootPageID);
+    std::vector<PageID> current{ m_RootPageID };
     int level = 0;
 
     std::cout << "B+ Tree Structure:\n";
 
-    while (!q.empty()) {
-        int sz = q.size();
+    while (!current.empty()) {
         std::cout << "Level " << level << ":\n";
 
-        for (int i = 0; i < sz; ++i) {
-            PageID pageID = q.front();
-            q.pop();
+        // The whole level is known up front, read it ahead in one batch
+        m_BufferPool.prefetch(current);
 
-            Page& page = m_BufferPool.fetchPage(pageID);
-            BPlusTreeNode node(page);
+        std::vector<PageID> next;
+        for (PageID pageID : current) {
+            ReadPageGuard guard = m_BufferPool.fetchPageRead(pageID);
+            BPlusTreeNode node(guard.page());
 
             int n = node.getNumKeys();
             std::cout << "[Page " << pageID << "] ";
@@ -39,16 +38,15 @@ void BPlusTree::print() {
             std::cout << "  ";
 
             if (!node.isLeaf()) {
-                // Push child pointers to queue
+                // Collect child pointers for the next level
                 for (int j = 0; j <= n; ++j) {
-                    q.push(node.getChild(j));
+                    next.push_back(node.getChild(j));
                 }
             }
-
-            m_BufferPool.unpinPage(pageID);
         }
 
         std::cout << "\n";
+        current = std::move(next);
         ++level;
     }
 
@@ -0,0 +1,82 @@
+#include "pebble/core/BPlusTree.h"
+
+#include <utility>
+#include <vector>
+
+using namespace pebble::core;
+
+std::vector<PageID> BPlusTree::nodePages() {
+    std::vector<PageID> pages;
+    if (m_RootPageID == 0)
+        return pages;
+
+    std::vector<PageID> current{ m_RootPageID };
+    while (!current.empty()) {
+        m_BufferPool.prefetch(current);
+
+        std::vector<PageID> next;
+        for (PageID pageID : current) {
+            ReadPageGuard guard = m_BufferPool.fetchPageRead(pageID);
+            BPlusTreeNode node(guard.page());
+
+            if (!node.isLeaf()) {
+                for (int j = 0; j <= node.getNumKeys(); ++j) {
+                    next.push_back(static_cast<PageID>(node.getChild(j)));
+                }
+            }
+        }
+
+        pages.insert(pages.end(), current.begin(), current.end());
+        current = std::move(next);
+    }
+
+    return pages;
+}
+
+void BPlusTree::relocate(const std::unordered_map<PageID, PageID>& moved,
+                         const std::function<uint64_t(uint64_t)>& remapValue) {
+    auto newID = [&](PageID pageID) {
+        auto it = moved.find(pageID);
+        return it == moved.end() ? pageID : it->second;
+    };
+
+    if (m_RootPageID == 0)
+        return;
+    m_RootPageID = newID(m_RootPageID);
+
+    // Nodes are reached through their parents' already fixed pointers, so by their new IDs
+    std::vector<PageID> current{ m_RootPageID };
+    while (!current.empty()) {
+        m_BufferPool.prefetch(current);
+
+        std::vector<PageID> next;
+        for (PageID pageID : current) {
+            // Read through a const view: only nodes that change are marked dirty
+            WritePageGuard guard = m_BufferPool.fetchPageWrite(pageID);
+            BPlusTreeNode node(std::as_const(guard).page());
+
+            if (node.isLeaf()) {
+                for (int j = 0; j < node.getNumKeys(); ++j) {
+                    uint64_t value = node.getValue(j);
+                    uint64_t newValue = remapValue(value);
+                    if (newValue != value)
+                        BPlusTreeNode(guard.page()).setValue(j, newValue);
+                }
+
+                PageID nextLeaf = node.getNextLeaf();
+                if (nextLeaf != 0 && newID(nextLeaf) != nextLeaf)
+                    BPlusTreeNode(guard.page()).setNextLeaf(newID(nextLeaf));
+            }
+            else {
+                for (int j = 0; j <= node.getNumKeys(); ++j) {
+                    PageID child = static_cast<PageID>(node.getChild(j));
+                    if (newID(child) != child)
+                        BPlusTreeNode(guard.page()).setChild(j, newID(child));
+                    next.push_back(newID(child));
+                }
+            }
+        }
+
+        current = std::move(next);
+    }
+}
@@ -1,5 +1,7 @@
 #include "pebble/core/BPlusTree.h"
 
+#include <utility>
+
 using namespace pebble::core;
 
 bool BPlusTree::remove(int key)
@@ -9,10 +11,10 @@ bool BPlusTree::remove(int key)
 	}
 
     bool deleted{ false };
-	bool rootUnderflow = removeInternal(key, m_RootPageID, deleted);
+	removeInternal(key, m_RootPageID, deleted);
 
-	Page& rootPage = m_BufferPool.fetchPage(m_RootPageID);
-    BPlusTreeNode rootNode(rootPage);
+    ReadPageGuard rootGuard = m_BufferPool.fetchPageRead(m_RootPageID);
+    BPlusTreeNode rootNode(rootGuard.page());
 
     if(rootNode.getNumKeys() == 0) {
         if (!rootNode.isLeaf()) {
@@ -20,16 +22,9 @@ bool BPlusTree::remove(int key)
             PageID newRootID = rootNode.getChild(0);
             m_RootPageID = newRootID;
         }
-        else
-        {
-            // Tree is now empty
-            m_RootPageID = INVALID_PAGE;
-        }
+        // An empty leaf root stays, the next insert goes there
 	}
 
-    m_BufferPool.markDirty(m_RootPageID);
-    m_BufferPool.unpinPage(m_RootPageID);
-
     return deleted;
 }
 
@@ -39,32 +34,32 @@ bool BPlusTree::removeInternal(
     bool& deleted
 )
 {
-    Page& nodePage = m_BufferPool.fetchPage(nodeID);
-    BPlusTreeNode node(nodePage);
+    // Read through a const view, the node is only marked dirty once it changes
+    WritePageGuard nodeGuard = m_BufferPool.fetchPageWrite(nodeID);
+    BPlusTreeNode view(std::as_const(nodeGuard).page());
 
     // ===== LEAF NODE =====
-    if (node.isLeaf())
+    if (view.isLeaf())
     {
-        int idx = node.findKeyIndex(key);
-        if (idx < 0 || node.getKey(idx) != key) {
+        int idx = view.findKeyIndex(key);
+        if (idx < 0) {
             deleted = false;
             return false;       // key not found
         }
 
+        BPlusTreeNode node(nodeGuard.page());
         node.removeKeyAt(idx);
         node.removeValueAt(idx);
 
         node.setNumKeys(node.getNumKeys() - 1);
         deleted = true;
 
-        m_BufferPool.markDirty(nodeID);
-        m_BufferPool.unpinPage(nodeID);
         return node.getNumKeys() < m_MinKeys;
     }
             
     // ====== INTERNAL NODE ======
-    int idx = node.findChildIndex(key);
-    PageID childID = node.getChild(idx);
+    int idx = view.findChildIndex(key);
+    PageID childID = view.getChild(idx);
     bool childDeleted = false;
     bool childUnderflow = removeInternal(key, childID, childDeleted);
     deleted = childDeleted;
@@ -73,24 +68,26 @@ bool BPlusTree::removeInternal(
         return false;
 
     // Handle Underflow
+    BPlusTreeNode node(nodeGuard.page());
     PageID leftSiblingID = (idx > 0) ? node.getChild(idx - 1) : INVALID_PAGE;
     PageID rightSiblingID = (idx < node.getNumKeys()) ? node.getChild(idx + 1) : INVALID_PAGE;
 
-    Page& childPage = m_BufferPool.fetchPage(childID);
-    BPlusTreeNode childNode(childPage);
+    WritePageGuard childGuard = m_BufferPool.fetchPageWrite(childID);
+    BPlusTreeNode childNode(childGuard.page());
 
     // TRY: Borrow from Left Sibling
+    WritePageGuard leftGuard;
     if (leftSiblingID != INVALID_PAGE)
     {
-        Page& leftPage = m_BufferPool.fetchPage(leftSiblingID);
-        BPlusTreeNode leftNode(leftPage);
+        leftGuard = m_BufferPool.fetchPageWrite(leftSiblingID);
+        BPlusTreeNode leftNode(leftGuard.page());
 
         if (leftNode.getNumKeys() > m_MinKeys)
         {
             if (childNode.isLeaf()) {
                 // Move Last key from left to front of the child
                 int borrowKey = leftNode.getKey(leftNode.getNumKeys() - 1);
-                int borrowVal = leftNode.getValue(leftNode.getNumValues() - 1);
+                uint64_t borrowVal = leftNode.getValue(leftNode.getNumValues() - 1);
 
                 leftNode.removeKeyAt(leftNode.getNumKeys() - 1);
                 leftNode.removeValueAt(leftNode.getNumKeys() - 1);
@@ -117,30 +114,23 @@ bool BPlusTree::removeInternal(
                 node.setKey(idx - 1, borrowKey);
             }
 
-            m_BufferPool.markDirty(childID);
-            m_BufferPool.markDirty(nodeID);
-            m_BufferPool.markDirty(leftSiblingID);
-            
-            m_BufferPool.unpinPage(childID);
-            m_BufferPool.unpinPage(nodeID);
-            m_BufferPool.unpinPage(leftSiblingID);
-
             return false;
         }
     }
 
     // TRY: Borrow from right Sibling
+    WritePageGuard rightGuard;
     if (rightSiblingID != INVALID_PAGE)
     {
-        Page& rightPage = m_BufferPool.fetchPage(rightSiblingID);
-        BPlusTreeNode rightNode(rightPage);
+        rightGuard = m_BufferPool.fetchPageWrite(rightSiblingID);
+        BPlusTreeNode rightNode(rightGuard.page());
 
         if (rightNode.getNumKeys() > m_MinKeys)
         {
             if (childNode.isLeaf())
             {
                 int borrowKey = rightNode.getKey(0);
-                int borrowVal = rightNode.getValue(0);
+                uint64_t borrowVal = rightNode.getValue(0);
 
                 rightNode.removeKeyAt(0);
                 rightNode.removeValueAt(0);
@@ -169,43 +159,17 @@ bool BPlusTree::removeInternal(
                 node.setKey(idx, borrowKey);
             }
 
-            m_BufferPool.markDirty(childID);
-            m_BufferPool.markDirty(nodeID);
-            m_BufferPool.markDirty(rightSiblingID);
-
-            m_BufferPool.unpinPage(childID);
-            m_BufferPool.unpinPage(nodeID);
-            m_BufferPool.unpinPage(rightSiblingID);
-
             return false;
         }
     }
 
     // Merge with Sibling
-    if (leftSiblingID != INVALID_PAGE) {
-        mergeNodes(leftSiblingID, childID, node, idx - 1);
-
-        m_BufferPool.markDirty(childID);
-        m_BufferPool.markDirty(nodeID);
-        m_BufferPool.markDirty(leftSiblingID);
-
-        m_BufferPool.unpinPage(childID);
-        m_BufferPool.unpinPage(nodeID);
-        m_BufferPool.unpinPage(leftSiblingID);
-
+    if (leftGuard) {
+        mergeNodes(leftGuard, childGuard, node, idx - 1);
         return node.getNumKeys() < m_MinKeys;
     }
-    else if (rightSiblingID != INVALID_PAGE) {
-        mergeNodes(childID, rightSiblingID, node, idx);
-
-        m_BufferPool.markDirty(childID);
-        m_BufferPool.markDirty(nodeID);
-        m_BufferPool.markDirty(rightSiblingID);
-
-        m_BufferPool.unpinPage(childID);
-        m_BufferPool.unpinPage(nodeID);
-        m_BufferPool.unpinPage(rightSiblingID);
-
+    else if (rightGuard) {
+        mergeNodes(childGuard, rightGuard, node, idx);
         return node.getNumKeys() < m_MinKeys;
     }
 
@@ -213,12 +177,9 @@ bool BPlusTree::removeInternal(
 }
 
 
-void BPlusTree::mergeNodes(PageID leftID, PageID rightID, BPlusTreeNode& parent, int separatorIdx) {
-    Page& leftPage = m_BufferPool.fetchPage(leftID);
-    Page& rightPage = m_BufferPool.fetchPage(rightID);
-
-    BPlusTreeNode left(leftPage);
-    BPlusTreeNode right(rightPage);
+void BPlusTree::mergeNodes(WritePageGuard& leftGuard, WritePageGuard& rightGuard, BPlusTreeNode& parent, int separatorIdx) {
+    BPlusTreeNode left(leftGuard.page());
+    BPlusTreeNode right(std::as_const(rightGuard).page());
 
     if (left.isLeaf()) {
         // Append all keys and values from right to left
@@ -227,19 +188,21 @@ void BPlusTree::mergeNodes(PageID leftID, PageID rightID, BPlusTreeNode& parent,
             left.insertValueAt(left.getNumKeys(), right.getValue(i));
             left.setNumKeys(left.getNumKeys() + 1);
         }
+        left.setNextLeaf(right.getNextLeaf());
     }
     else {
         // Append separator key from parent
         left.insertKeyAt(left.getNumKeys(), parent.getKey(separatorIdx));
         left.setNumKeys(left.getNumKeys() + 1);
 
-        // Append all keys and children from right
+        // Append all keys and children from right, its first child follows the separator
+        int firstChild = left.getNumKeys();
         for (int i = 0; i < right.getNumKeys(); ++i) {
             left.insertKeyAt(left.getNumKeys(), right.getKey(i));
             left.setNumKeys(left.getNumKeys() + 1);
         }
         for (int i = 0; i <= right.getNumKeys(); ++i) {
-            left.insertChildAt(left.getNumKeys(), right.getChild(i));
+            left.setChild(firstChild + i, right.getChild(i));
         }
     }
 
@@ -248,14 +211,8 @@ void BPlusTree::mergeNodes(PageID leftID, PageID rightID, BPlusTreeNode& parent,
     parent.removeChildAt(separatorIdx + 1);
     parent.setNumKeys(parent.getNumKeys() - 1);
 
-    // Mark dirty
-    m_BufferPool.markDirty(leftID);
-    m_BufferPool.markDirty(rightID);
-
-    // Unpin
-    m_BufferPool.unpinPage(leftID);
-    m_BufferPool.unpinPage(rightID);
-
-    // Free the right Page
+    // Free the right Page, its frame must be unpinned first
+    PageID rightID = rightGuard.pageID();
+    rightGuard.release();
     m_BufferPool.freePage(rightID);
 }
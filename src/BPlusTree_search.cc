@@ -10,31 +10,23 @@ std::optional<uint64_t> BPlusTree::search(int key)
 
 std::optional<uint64_t> BPlusTree::searchInternal(int key, uint32_t pageID)
 {
-    Page& page = m_BufferPool.fetchPage(pageID);
-    BPlusTreeNode node(page);
+    // Latch coupling: the child is latched before the parent is let go
+    ReadPageGuard guard = m_BufferPool.fetchPageRead(pageID);
 
-    int n = node.getNumKeys();
-
-    if (node.isLeaf())
+    while (true)
     {
-
-        for (int i = 0; i < n; ++i) {
-            if (node.getKey(i) == key) {
-                return node.getValue(i);  // pointer = value (record ID)
-            }
+        BPlusTreeNode node(guard.page());
+
+        if (node.isLeaf())
+        {
+            int idx = node.findKeyIndex(key);
+            if (idx < 0)
+                return std::nullopt;  // not found in leaf
+            return node.getValue(idx);  // pointer = value (record ID)
         }
 
-        return std::nullopt;  // not found in leaf
-    }
-    else
-    {
         // Internal: find correct child to descend into
-        int idx = 0;
-        while (idx < n && key >= node.getKey(idx)) {
-            idx++;
-        }
-
-        // Descend into child at index `idx`
-        return searchInternal(key, node.getChild(idx));
+        int idx = node.findChildIndex(key);
+        guard = m_BufferPool.fetchPageRead(static_cast<PageID>(node.getChild(idx)));
     }
 }
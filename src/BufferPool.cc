@@ -1,20 +1,118 @@
 #include "pebble/core/BufferPool.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <thread>
 
 using namespace pebble::core;
 
-BufferPool::BufferPool(IFileManager& fm, size_t poolSize)
-    : m_FileManager(fm), m_MaxPages(poolSize)
-{}
+namespace {
+
+    // Power-of-two shard count: requested (0 = hardware threads), at most one per MIN_SHARD_FRAMES
+    size_t shardCountFor(size_t poolSize, size_t requested) {
+        if (requested == 0)
+            requested = std::max(1u, std::thread::hardware_concurrency());
+
+        size_t limit = std::max<size_t>(1, poolSize / BufferPool::MIN_SHARD_FRAMES);
+        return std::bit_floor(std::min(requested, limit));
+    }
+
+    // Share i of `total` frames split over `count` shards, the first total % count take one more
+    uint32_t shareOf(size_t total, size_t count, size_t i) {
+        return static_cast<uint32_t>(total / count + (i < total % count ? 1 : 0));
+    }
+
+    // Shard selection must not correlate with the high bits PageTable hashes on
+    uint32_t mixPageID(uint32_t pageID) {
+        pageID ^= pageID >> 16;
+        pageID *= 0x85EBCA6Bu;
+        pageID ^= pageID >> 13;
+        pageID *= 0xC2B2AE35u;
+        pageID ^= pageID >> 16;
+        return pageID;
+    }
+
+}
+
+BufferPool::Shard::Shard(uint32_t first, uint32_t count, uint32_t limit, ReplacementPolicyType type)
+    : firstFrame(first), frameCount(count), frameLimit(limit), pageTable(count),
+      policy(createReplacementPolicy(type, count))
+{
+    // lowest frames are handed out first, the ones above the limit wait for the pool to grow
+    freeFrames.reserve(count);
+    for (uint32_t i = count; i-- > limit; ) {
+        retiredFrames.push_back(first + i);
+    }
+    for (uint32_t i = limit; i-- > 0; ) {
+        freeFrames.push_back(first + i);
+    }
+}
+
+BufferPool::BufferPool(IFileManager& fm, size_t poolSize, ReplacementPolicyType policy, size_t shards,
+                       HugePageMode hugePages, size_t maxPoolSize)
+    : m_FileManager(fm), m_MaxPages(std::max(poolSize, maxPoolSize)), m_PoolSize(poolSize),
+      m_Arena(m_MaxPages, hugePages)
+{
+    m_Frames.reserve(m_MaxPages);
+    for (size_t i = 0; i < m_MaxPages; ++i) {
+        m_Frames.emplace_back(Page(m_Arena.page(i)));
+    }
+
+    // Contiguous slices of the capacity, each shard using its share of poolSize
+    size_t count = shardCountFor(poolSize, shards);
+    uint32_t first = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t frames = shareOf(m_MaxPages, count, i);
+        m_Shards.push_back(std::make_unique<Shard>(first, frames, shareOf(poolSize, count, i), policy));
+        first += frames;
+    }
+    m_ShardMask = static_cast<uint32_t>(count - 1);
+}
 
 BufferPool::~BufferPool()
 {
+    stopCleaner();
     flushAll();  // Ensure all dirty pages are flushed to disk
 }
 
+BufferPool::Shard& BufferPool::shardOf(uint32_t pageID)
+{
+    return *m_Shards[mixPageID(pageID) & m_ShardMask];
+}
+
 Page& BufferPool::fetchPage(uint32_t pageID)
+{
+    return pinFrame(pageID).page;
+}
+
+ReadPageGuard BufferPool::fetchPageRead(uint32_t pageID)
+{
+    return ReadPageGuard(pinFrame(pageID));
+}
+
+WritePageGuard BufferPool::fetchPageWrite(uint32_t pageID)
+{
+    return WritePageGuard(pinFrame(pageID));
+}
+
+WritePageGuard BufferPool::newPage(uint32_t nearPageID)
+{
+    uint32_t pageID = m_FileManager.allocatePagesUnwritten(1, nearPageID);
+    return WritePageGuard(pinFrame(pageID, true));
+}
+
+Frame& BufferPool::pinFrame(uint32_t pageID, bool fresh)
 {   
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Tracing.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> traceLock(m_TraceMutex);
+        if (m_AccessTrace)
+            m_AccessTrace(pageID);
+    }
+
+    Shard& shard = shardOf(pageID);
+    std::unique_lock<std::mutex> lock(shard.mutex);
     
 	// CATALOG PAGE : ensure catalog page (1) exists
     if (pageID == 1 && !m_FileManager.pageExists(1)) {
@@ -23,31 +121,115 @@ Page& BufferPool::fetchPage(uint32_t pageID)
         m_FileManager.writePage(cat); // direct write, no allocatePage()
     }
 
-    auto it = m_Pages.find(pageID);
-    if(it != m_Pages.end())         // Page found in memory
-    {
-        it->second.pinCount++;
-        touchLRU(pageID);
-        return it->second.page;
+    // A fresh page is not a lookup: it can only miss
+    if (!fresh)
+        ++shard.fetches;
+    bool counted = fresh;
+
+    uint32_t index;
+    while (true) {
+        if (!lock.owns_lock())
+            lock.lock();
+
+        index = shard.pageTable.find(pageID);
+        if(index != PageTable::NO_FRAME)        // Page found in memory
+        {
+            Frame& frame = m_Frames[index];
+            frame.pinCount++;
+            if (!counted) {
+                ++shard.hits;
+                counted = true;
+            }
+
+            // The first fetch of a prefetched page is the reference its load already counted
+            if (frame.prefetched)
+                frame.prefetched = false;
+            else
+                shard.policy->recordHit(index - shard.firstFrame);
+
+            if (frame.state.load(std::memory_order_acquire) != FrameState::LOADING)
+                return frame;
+
+            // Another thread is reading it in: wait for that frame alone
+            lock.unlock();
+            if (awaitLoad(shard, frame))
+                return frame;
+            continue;
+        }
+
+        index = takeFreeFrame(shard, lock);
+        if (index != PageTable::NO_FRAME)
+            break;
+    }
+
+    // Claim the frame for pageID, then read it in without the shard latch. Fetches of pageID
+    // meanwhile find it LOADING and wait.
+    Frame& frame = m_Frames[index];
+    frame.pageID = pageID;
+    frame.dirty = fresh;
+    frame.pinCount = 1;
+    frame.prefetched = false;
+    frame.state.store(FrameState::LOADING, std::memory_order_relaxed);
+
+    shard.pageTable.insert(pageID, index);
+    shard.policy->recordLoad(index - shard.firstFrame, pageID);
+    lock.unlock();
+
+    if (fresh) {
+        frame.page.clear();
+        frame.page.setPageID(pageID);
+        finishLoad(shard, frame, true);
+        return frame;
     }
 
-    if(m_Pages.size() >= m_MaxPages) {
-        evictPage();
+    try {
+        m_FileManager.readPage(pageID, frame.page);
+    } catch (...) {
+        finishLoad(shard, frame, false);
+        throw;
     }
+    finishLoad(shard, frame, true);
 
-    // Load page from disk
-    Page p;
-    m_FileManager.readPage(pageID, p);
+    return frame;
+}
 
-    // pin the page
-    Frame frame(std::move(p));
-    frame.pinCount = 1;
+bool BufferPool::awaitLoad(Shard& shard, Frame& frame)
+{
+    FrameState state;
+    while ((state = frame.state.load(std::memory_order_acquire)) == FrameState::LOADING)
+        frame.state.wait(FrameState::LOADING, std::memory_order_acquire);
 
-    // cache the page in memory
-    m_Pages[pageID] = std::move(frame);
-    m_LRU.push_front(pageID);
+    if (state != FrameState::FREE)
+        return true;
 
-    return m_Pages[pageID].page;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    unpinFailedLoad(shard, frame);
+    return false;
+}
+
+void BufferPool::finishLoad(Shard& shard, Frame& frame, bool loaded)
+{
+    if (loaded) {
+        frame.state.store(FrameState::RESIDENT, std::memory_order_release);
+        frame.state.notify_all();
+        return;
+    }
+
+    // Withdraw the page; the frame is reusable once every waiter has seen the failure
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.policy->forget(static_cast<uint32_t>(&frame - m_Frames.data()) - shard.firstFrame);
+    shard.pageTable.erase(frame.pageID);
+    frame.pageID = Frame::NO_PAGE;
+    frame.prefetched = false;
+    frame.state.store(FrameState::FREE, std::memory_order_release);
+    frame.state.notify_all();
+    unpinFailedLoad(shard, frame);
+}
+
+void BufferPool::unpinFailedLoad(Shard& shard, Frame& frame)
+{
+    if (frame.pinCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        shard.freeFrames.push_back(static_cast<uint32_t>(&frame - m_Frames.data()));
 }
 
 uint32_t BufferPool::allocatePage()
@@ -55,84 +237,677 @@ uint32_t BufferPool::allocatePage()
     return m_FileManager.allocatePage();
 }
 
+uint32_t BufferPool::allocatePages(uint32_t count, uint32_t nearPageID)
+{
+    return m_FileManager.allocatePages(count, nearPageID);
+}
+
 void BufferPool::markDirty(uint32_t pageID)
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    Shard& shard = shardOf(pageID);
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-    auto it = m_Pages.find(pageID);
-    if(it != m_Pages.end()) {
-        it->second.dirty = true;
+    uint32_t index = shard.pageTable.find(pageID);
+    if(index != PageTable::NO_FRAME) {
+        m_Frames[index].dirty = true;
     }
 }
 
 void BufferPool::unpinPage(uint32_t pageID)
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    Shard& shard = shardOf(pageID);
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-    auto it = m_Pages.find(pageID);
-    if(it != m_Pages.end()) {
-        it->second.pinCount -= 1;
+    uint32_t index = shard.pageTable.find(pageID);
+    if(index != PageTable::NO_FRAME) {
+        m_Frames[index].pinCount -= 1;
     }
 }
 
 void BufferPool::flushPage(uint32_t pageID)
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    auto it = m_Pages.find(pageID);
-    if(it != m_Pages.end() && it->second.dirty) {
+    Shard& shard = shardOf(pageID);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    uint32_t index = shard.pageTable.find(pageID);
+    if(index != PageTable::NO_FRAME && m_Frames[index].dirty) {
         std::cout << "flushPage(" << pageID << ")\n";
-        m_FileManager.writePage(it->second.page);
-        it->second.dirty = false;
+        m_FileManager.writePage(m_Frames[index].page);
+        m_Frames[index].dirty = false;
     }
 }
 
 void BufferPool::flushAll()
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    // Every shard stays locked until the batch is written, always taken in index order. A
+    // write-back in flight is waited out: its pages are no longer dirty, but must be durable too.
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for(auto& shard : m_Shards) {
+        locks.emplace_back(shard->mutex);
+        shard->writtenBack.wait(locks.back(), [&shard]() { return shard->writingBack == 0; });
+    }
+
+    // What is resident now is what a restart should load first. The file is written once the
+    // shards are unlocked.
+    bool warmRestart;
+    {
+        std::lock_guard<std::mutex> lock(m_WarmRestartMutex);
+        warmRestart = !m_WarmRestartPath.empty();
+    }
+    std::vector<uint32_t> hot;
+    if(warmRestart)
+        hot = residentPages();
+
+    // hand every dirty page over as one batch, the file manager orders and coalesces them.
+    // A page under a write guard is mid-update: it stays dirty for the next flush. Waiting for
+    // its latch here could deadlock with the guard's owner fetching another page. A LOADING frame
+    // is not latched yet: a newPage() frame is dirty and zeroed outside the shard latch, so only
+    // frames whose load has finished are written.
+    std::vector<Frame*> latched;
+    std::vector<const Page*> batch;
+    for(Frame& frame : m_Frames) {
+        if(frame.pageID != Frame::NO_PAGE && frame.dirty &&
+           frame.state.load(std::memory_order_acquire) == FrameState::RESIDENT && frame.latch.try_lock_shared()) {
+            latched.push_back(&frame);
+            batch.push_back(&frame.page);
+            frame.dirty = false;
+        }
+    }
+    auto unlatch = [&latched]() {
+        for(Frame* frame : latched)
+            frame->latch.unlock_shared();
+    };
+    try {
+        if(!batch.empty())
+            m_FileManager.writePages(std::move(batch));
+    } catch(...) {
+        // Nothing says which pages reached the disk: all of them stay dirty for the next attempt
+        for(Frame* frame : latched)
+            frame->dirty = true;
+        unlatch();
+        throw;
+    }
+    unlatch();
+
+    // persist allocation metadata and make the writes durable
+    m_FileManager.flush();
+    locks.clear();
+
+    if(warmRestart)
+        saveResidentPages(hot);
+}
+
+uint32_t BufferPool::takeFreeFrame(Shard& shard, std::unique_lock<std::mutex>& lock)
+{
+    trimFreeFrames(shard);
+    if(shard.freeFrames.empty()) {
+        uint32_t index = evictPage(shard, lock);
+        if(index == PageTable::NO_FRAME || !shard.overLimit())
+            return index;
+
+        // Over the limit while a shrink is under way, or after one that found pages pinned:
+        // retire this victim and evict another. One extra frame per miss, resize() does the rest.
+        retireFrame(shard, index);
+        return evictPage(shard, lock);
+    }
+
+    uint32_t index = shard.freeFrames.back();
+    shard.freeFrames.pop_back();
+    return index;
+}
+
+uint32_t BufferPool::pickVictim(Shard& shard) const
+{
+    // The policy proposes victims in order, the first unpinned one goes. Two captures keep the
+    // callback within std::function's inline storage.
+    uint32_t slot = PageTable::NO_FRAME;
+    const Frame* frames = &m_Frames[shard.firstFrame];
+    shard.policy->forEachVictim([frames, &slot](uint32_t candidate) {
+        if(frames[candidate].pinCount != 0)
+            return true;
+        slot = candidate;
+        return false;
+    });
+    return slot;
+}
+
+void BufferPool::dropPage(Shard& shard, uint32_t slot)
+{
+    Frame& frame = m_Frames[shard.firstFrame + slot];
+    m_Evictions.fetch_add(1, std::memory_order_relaxed);
+    shard.policy->recordEvict(slot);
+    shard.pageTable.erase(frame.pageID);
+    frame.pageID = Frame::NO_PAGE;
+    frame.state.store(FrameState::FREE, std::memory_order_relaxed);
+}
+
+uint32_t BufferPool::evictPage(Shard& shard, std::unique_lock<std::mutex>& lock)
+{
+    uint32_t slot = pickVictim(shard);
+    if(slot == PageTable::NO_FRAME) {
+        if(shard.writingBack == 0)
+            throw std::runtime_error("No unpinned pages available for eviction");
+
+        // victims will be unpinned once their write-back completes
+        shard.writtenBack.wait(lock);
+        lock.unlock();
+        return PageTable::NO_FRAME;
+    }
+
+    uint32_t victim = shard.firstFrame + slot;
+    Frame& frame = m_Frames[victim];
+    if(frame.dirty) {
+        // The cleaner fell behind: write back a batch of the next victims, so the next few
+        // evictions find clean ones, and have it catch up. The shard stays usable meanwhile.
+        m_StalledEvictions.fetch_add(1, std::memory_order_relaxed);
+        std::vector<Frame*> batch = beginWriteBack(shard, shard.frameCount, EVICTION_WRITE_BATCH);
+        lock.unlock();
+
+        if(m_Cleaner.joinable()) {
+            {
+                std::lock_guard<std::mutex> cleanerLock(m_CleanerMutex);
+                m_CleanerKicked = true;
+            }
+            m_CleanerWake.notify_one();
+        }
+
+        writeBack(shard, batch);
+        m_StallPagesWritten.fetch_add(batch.size(), std::memory_order_relaxed);
+        return PageTable::NO_FRAME;
+    }
+
+    dropPage(shard, slot);
+    return victim;
+}
+
+void BufferPool::trimFreeFrames(Shard& shard)
+{
+    while(shard.overLimit() && !shard.freeFrames.empty()) {
+        retireFrame(shard, shard.freeFrames.back());
+        shard.freeFrames.pop_back();
+    }
+}
+
+void BufferPool::retireFrame(Shard& shard, uint32_t index)
+{
+    // Still latched: growing may hand the frame out again right after
+    shard.retiredFrames.push_back(index);
+    m_Arena.release(index, 1);
+}
+
+void BufferPool::shrinkShard(Shard& shard)
+{
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    while(true) {
+        trimFreeFrames(shard);
+
+        // A batch of victims per latch hold, fetches of the shard get in between
+        for(size_t i = 0; i < SHRINK_BATCH && shard.overLimit(); ++i) {
+            uint32_t slot = pickVictim(shard);
+            if(slot == PageTable::NO_FRAME)
+                return;         // all pinned: takeFreeFrame() retires them as they are evicted
+
+            if(m_Frames[shard.firstFrame + slot].dirty) {
+                std::vector<Frame*> batch = beginWriteBack(shard, shard.frameCount, EVICTION_WRITE_BATCH);
+                if(batch.empty())
+                    return;
+                lock.unlock();
+                writeBack(shard, batch);
+                lock.lock();
+                break;
+            }
+            dropPage(shard, slot);
+            retireFrame(shard, shard.firstFrame + slot);
+        }
+        if(!shard.overLimit())
+            return;
+
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+    }
+}
+
+void BufferPool::resize(size_t poolSize)
+{
+    if(poolSize < m_Shards.size() || poolSize > m_MaxPages) {
+        throw std::invalid_argument("Buffer pool size must be between " + std::to_string(m_Shards.size()) +
+                                    " and " + std::to_string(m_MaxPages) + " frames");
+    }
 
-    for(auto &[pageID, frame]: m_Pages) {
-        if(frame.dirty) {
-            m_FileManager.writePage(frame.page);
+    std::lock_guard<std::mutex> resizeLock(m_ResizeMutex);
+    m_PoolSize.store(poolSize, std::memory_order_relaxed);
+
+    // Growing hands retired frames back at once, shrinking lowers the limit shard by shard
+    for(size_t i = 0; i < m_Shards.size(); ++i) {
+        Shard& shard = *m_Shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.frameLimit = shareOf(poolSize, m_Shards.size(), i);
+        while(shard.frameCount - shard.retiredFrames.size() < shard.frameLimit) {
+            shard.freeFrames.push_back(shard.retiredFrames.back());
+            shard.retiredFrames.pop_back();
+        }
+    }
+    for(auto& shard : m_Shards) {
+        shrinkShard(*shard);
+    }
+}
+
+std::vector<Frame*> BufferPool::beginWriteBack(Shard& shard, size_t window, size_t limit)
+{
+    // An unpinned frame has no guard, so its latch is free; latching it shared makes a write
+    // guard taken meanwhile wait until the page is written
+    std::vector<Frame*> batch;
+    Frame* slice = &m_Frames[shard.firstFrame];
+    size_t seen = 0;
+    shard.policy->forEachVictim([&](uint32_t slot) {
+        Frame& frame = slice[slot];
+        if(frame.pinCount == 0 && frame.dirty && frame.latch.try_lock_shared()) {
+            frame.pinCount++;
             frame.dirty = false;
+            frame.state.store(FrameState::WRITING_BACK, std::memory_order_relaxed);
+            batch.push_back(&frame);
         }
+        return ++seen < window && batch.size() < limit;
+    });
+    shard.writingBack += static_cast<uint32_t>(batch.size());
+    return batch;
+}
+
+void BufferPool::writeBack(Shard& shard, const std::vector<Frame*>& frames)
+{
+    auto finish = [&](bool written) {
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for(Frame* frame : frames) {
+                if(!written)
+                    frame->dirty = true;
+                frame->state.store(FrameState::RESIDENT, std::memory_order_release);
+                frame->state.notify_all();
+                frame->latch.unlock_shared();
+                frame->pinCount.fetch_sub(1, std::memory_order_release);
+            }
+            shard.writingBack -= static_cast<uint32_t>(frames.size());
+        }
+        shard.writtenBack.notify_all();
+    };
+
+    if(frames.empty())
+        return;
+
+    std::vector<const Page*> batch;
+    batch.reserve(frames.size());
+    for(Frame* frame : frames)
+        batch.push_back(&frame->page);
+
+    try {
+        m_FileManager.writePages(std::move(batch));
+    } catch(...) {
+        finish(false);
+        throw;
     }
+    finish(true);
 }
 
-void BufferPool::touchLRU(uint32_t pageID)
+void BufferPool::startCleaner(double cleanFraction, std::chrono::milliseconds interval)
 {
-    m_LRU.remove(pageID);
-    m_LRU.push_front(pageID);
+    stopCleaner();
+
+    m_CleanFraction = std::clamp(cleanFraction, 0.0, 1.0);
+    m_CleanerInterval = interval;
+    m_CleanerStop = false;
+    m_CleanerKicked = false;
+    m_Cleaner = std::thread(&BufferPool::cleanerLoop, this);
 }
 
-void BufferPool::evictPage()
+void BufferPool::stopCleaner()
 {
-    for(auto it = m_LRU.rbegin(); it != m_LRU.rend(); it++) 
+    if(!m_Cleaner.joinable())
+        return;
+
     {
-        uint32_t victimID = *it;
-        auto& frame = m_Pages[victimID];
+        std::lock_guard<std::mutex> lock(m_CleanerMutex);
+        m_CleanerStop = true;
+    }
+    m_CleanerWake.notify_one();
+    m_Cleaner.join();
+}
+
+void BufferPool::cleanerLoop()
+{
+    // Sleep only after a pass that found nothing to write
+    bool busy = false;
+    std::unique_lock<std::mutex> lock(m_CleanerMutex);
+    while(true) {
+        if(!busy)
+            m_CleanerWake.wait_for(lock, m_CleanerInterval, [this]() { return m_CleanerStop || m_CleanerKicked; });
+        if(m_CleanerStop)
+            return;
+        m_CleanerKicked = false;
+
+        lock.unlock();
+        busy = false;
+        for(auto& shard : m_Shards) {
+            try {
+                busy |= cleanShard(*shard) > 0;
+            } catch(const std::exception& e) {
+                // the pages stay dirty; eviction or flushAll() writes them and reports the error
+                std::cerr << "Buffer pool cleaner: " << e.what() << "\n";
+            }
+        }
+        lock.lock();
+    }
+}
 
-        if(frame.pinCount == 0) 
+size_t BufferPool::cleanShard(Shard& shard)
+{
+    size_t written = 0;
+    while(true) {
+        std::vector<Frame*> batch;
         {
-            if(frame.dirty) {
-                m_FileManager.writePage(frame.page);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            size_t window = std::max<size_t>(1, static_cast<size_t>(shard.frameLimit * m_CleanFraction));
+            batch = beginWriteBack(shard, window, CLEANER_WRITE_BATCH);
+        }
+        if(batch.empty())
+            return written;
+
+        auto start = std::chrono::steady_clock::now();
+        writeBack(shard, batch);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        m_CleanerBatches.fetch_add(1, std::memory_order_relaxed);
+        m_CleanerPagesWritten.fetch_add(batch.size(), std::memory_order_relaxed);
+        m_CleanerNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                                 std::memory_order_relaxed);
+
+        // a short batch means the window is clean
+        written += batch.size();
+        if(batch.size() < CLEANER_WRITE_BATCH)
+            return written;
+    }
+}
+
+BufferPoolStats BufferPool::stats() const
+{
+    BufferPoolStats stats;
+    stats.evictions = m_Evictions.load(std::memory_order_relaxed);
+    stats.stalledEvictions = m_StalledEvictions.load(std::memory_order_relaxed);
+    stats.stallPagesWritten = m_StallPagesWritten.load(std::memory_order_relaxed);
+    stats.cleanerBatches = m_CleanerBatches.load(std::memory_order_relaxed);
+    stats.cleanerPagesWritten = m_CleanerPagesWritten.load(std::memory_order_relaxed);
+    stats.cleanerSeconds = m_CleanerNanos.load(std::memory_order_relaxed) / 1e9;
+    for(auto& shard : m_Shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.frames += shard->frameCount - shard->retiredFrames.size();
+        stats.fetches += shard->fetches;
+        stats.hits += shard->hits;
+    }
+    return stats;
+}
+
+void BufferPool::prefetch(std::span<const uint32_t> pageIDs)
+{
+    if(!m_FileManager.supportsAsyncIO()) {
+        m_FileManager.prefetch(pageIDs);
+        return;
+    }
+
+    std::lock_guard<std::mutex> prefetchLock(m_PrefetchMutex);
+    loadPages(pageIDs, 1, true);
+}
+
+size_t BufferPool::loadPages(std::span<const uint32_t> pageIDs, unsigned readers, bool prefetched)
+{
+    // Claim free frames only for the missing pages, shard by shard, pinned and LOADING like a
+    // fetch's. A page listed twice is found the second time.
+    std::vector<uint32_t> loading;
+    {
+        std::vector<bool> touched(m_Shards.size(), false);
+        for(uint32_t pageID : pageIDs) {
+            touched[mixPageID(pageID) & m_ShardMask] = true;
+        }
+        std::vector<std::unique_lock<std::mutex>> locks;
+        for(size_t i = 0; i < m_Shards.size(); ++i) {
+            if(touched[i])
+                locks.emplace_back(m_Shards[i]->mutex);
+        }
+
+        for(uint32_t pageID : pageIDs) {
+            Shard& shard = shardOf(pageID);
+            trimFreeFrames(shard);
+            if(shard.freeFrames.empty())
+                continue;
+            if(shard.pageTable.find(pageID) != PageTable::NO_FRAME)
+                continue;
+
+            uint32_t index = shard.freeFrames.back();
+            shard.freeFrames.pop_back();
+
+            Frame& frame = m_Frames[index];
+            frame.pageID = pageID;
+            frame.dirty = false;
+            frame.pinCount = 1;
+            frame.prefetched = prefetched;
+            frame.state.store(FrameState::LOADING, std::memory_order_relaxed);
+            shard.pageTable.insert(pageID, index);
+            shard.policy->recordLoad(index - shard.firstFrame, pageID);
+            loading.push_back(index);
+        }
+    }
+
+    if(loading.empty())
+        return 0;
+
+    // Reads go without the shard latches: all in flight together with async I/O, else spread
+    // over `readers` threads. A failed page is dropped, fetchPage will retry and report the error.
+    std::vector<char> loaded(loading.size(), 1);
+    if(m_FileManager.supportsAsyncIO()) {
+        try {
+            for(uint32_t index : loading)
+                m_FileManager.readPageAsync(m_Frames[index].pageID, m_Frames[index].page);
+            m_FileManager.submit();
+            m_FileManager.waitAll();
+        } catch(const std::exception&) {
+            // Reads already issued must land before their frames are reused
+            std::fill(loaded.begin(), loaded.end(), 0);
+            try {
+                m_FileManager.waitAll();
+            } catch(const std::exception&) {
             }
-            m_Pages.erase(victimID);
-            m_LRU.erase(std::next(it).base());
+        }
+    }
+    else {
+        auto read = [&](size_t first) {
+            for(size_t i = first; i < loading.size(); i += readers) {
+                try {
+                    m_FileManager.readPage(m_Frames[loading[i]].pageID, m_Frames[loading[i]].page);
+                } catch(const std::exception&) {
+                    loaded[i] = 0;
+                }
+            }
+        };
+        readers = static_cast<unsigned>(std::clamp<size_t>(readers, 1, loading.size()));
+        std::vector<std::thread> threads;
+        for(unsigned t = 1; t < readers; ++t)
+            threads.emplace_back(read, t);
+        read(0);
+        for(auto& thread : threads)
+            thread.join();
+    }
+
+    size_t count = 0;
+    for(size_t i = 0; i < loading.size(); ++i) {
+        Frame& frame = m_Frames[loading[i]];
+        Shard& shard = shardOf(frame.pageID);
+        finishLoad(shard, frame, loaded[i]);
+        if(loaded[i]) {
+            frame.pinCount.fetch_sub(1, std::memory_order_release);
+            ++count;
+        }
+    }
+    return count;
+}
+
+void BufferPool::setWarmRestartFile(std::string path)
+{
+    std::lock_guard<std::mutex> lock(m_WarmRestartMutex);
+    m_WarmRestartPath = std::move(path);
+}
+
+std::vector<uint32_t> BufferPool::residentPages() const
+{
+    // Each shard's pages hottest first (the policy's victim order reversed), shards interleaved
+    std::vector<std::vector<uint32_t>> perShard;
+    size_t total = 0;
+    for(auto& shard : m_Shards) {
+        std::vector<uint32_t>& ids = perShard.emplace_back();
+        const Frame* frames = &m_Frames[shard->firstFrame];
+        shard->policy->forEachVictim([frames, &ids](uint32_t slot) {
+            ids.push_back(frames[slot].pageID);
+            return true;
+        });
+        std::reverse(ids.begin(), ids.end());
+        total += ids.size();
+    }
+
+    std::vector<uint32_t> hot;
+    hot.reserve(total);
+    for(size_t rank = 0; hot.size() < total; ++rank) {
+        for(auto& ids : perShard) {
+            if(rank < ids.size())
+                hot.push_back(ids[rank]);
+        }
+    }
+    return hot;
+}
+
+void BufferPool::saveResidentPages(const std::vector<uint32_t>& hot)
+{
+    std::lock_guard<std::mutex> lock(m_WarmRestartMutex);
+    if(m_WarmRestartPath.empty())
+        return;
+
+    // Replace the file only once the new list is complete. It is only a hint: a failure keeps
+    // the previous one and must not fail the flush.
+    std::string tmpPath = m_WarmRestartPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        uint32_t header[2] = { WARM_RESTART_MAGIC, static_cast<uint32_t>(hot.size()) };
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(hot.data()), hot.size() * sizeof(uint32_t));
+        if(out)
+            out.close();
+        if(!out) {
+            std::cerr << "Failed to write warm restart file " << tmpPath << "\n";
+            std::remove(tmpPath.c_str());
             return;
         }
     }
+    if(std::rename(tmpPath.c_str(), m_WarmRestartPath.c_str()) != 0) {
+        std::cerr << "Failed to replace warm restart file " << m_WarmRestartPath << "\n";
+        std::remove(tmpPath.c_str());
+    }
+}
+
+WarmupStats BufferPool::warmUp(unsigned readers)
+{
+    WarmupStats stats;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<uint32_t> hot;
+    {
+        std::lock_guard<std::mutex> lock(m_WarmRestartMutex);
+        std::ifstream in(m_WarmRestartPath, std::ios::binary | std::ios::ate);
+        std::streamoff length = in ? static_cast<std::streamoff>(in.tellg()) : 0;
+        in.seekg(0);
+        uint32_t header[2] = {};
+        if(!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != WARM_RESTART_MAGIC)
+            return stats;       // no file yet, or not ours
+
+        // A count the file cannot hold means it is truncated or corrupt: ignore it, as if missing
+        size_t stored = static_cast<size_t>(length - sizeof(header)) / sizeof(uint32_t);
+        if(header[1] > stored)
+            return stats;
+
+        // The hottest pages that fit
+        hot.resize(std::min<size_t>(header[1], poolSize()));
+        in.read(reinterpret_cast<char*>(hot.data()), hot.size() * sizeof(uint32_t));
+        hot.resize(in.gcount() / sizeof(uint32_t));
+    }
+
+    // Each batch read in page order. Pages freed or cut off since the list was saved are skipped.
+    std::erase_if(hot, [this](uint32_t pageID) { return !m_FileManager.pageExists(pageID); });
+    stats.pages = hot.size();
+
+    std::lock_guard<std::mutex> prefetchLock(m_PrefetchMutex);
+    for(size_t first = 0; first < hot.size(); first += WARMUP_BATCH) {
+        std::span<uint32_t> batch(hot.data() + first, std::min(WARMUP_BATCH, hot.size() - first));
+        std::sort(batch.begin(), batch.end());
+        if(!m_FileManager.supportsAsyncIO())
+            m_FileManager.prefetch(batch);
+        // Loaded in batch order, the hottest pages would be the first victims: their first
+        // fetch is a hit, not the reference the load already counted as with prefetch()
+        stats.loaded += loadPages(batch, readers, false);
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
 
-    throw std::runtime_error("No unpinned pages available for eviction");
+void BufferPool::setAccessTrace(std::function<void(uint32_t pageID)> sink)
+{
+    std::lock_guard<std::mutex> lock(m_TraceMutex);
+    m_AccessTrace = std::move(sink);
+    m_Tracing.store(static_cast<bool>(m_AccessTrace), std::memory_order_relaxed);
+}
+
+void BufferPool::adviseAccess(uint32_t pageID, uint32_t numPages, AccessPattern pattern)
+{
+    m_FileManager.adviseAccess(pageID, numPages, pattern);
 }
 
 void BufferPool::freePage(uint32_t pageID)
 {
-    std::lock_guard<std::mutex> lock(m_Mutex);
+    Shard& shard = shardOf(pageID);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+
+    // Remove from buffer pool if present, once no read or write-back uses its frame
+    uint32_t index;
+    while((index = shard.pageTable.find(pageID)) != PageTable::NO_FRAME) {
+        Frame& frame = m_Frames[index];
+        FrameState state = frame.state.load(std::memory_order_acquire);
+        if(state == FrameState::RESIDENT) {
+            shard.policy->forget(index - shard.firstFrame);
+            shard.pageTable.erase(pageID);
+            frame.pageID = Frame::NO_PAGE;
+            frame.dirty = false;
+            frame.state.store(FrameState::FREE, std::memory_order_relaxed);
+            shard.freeFrames.push_back(index);
+            break;
+        }
 
-    // Remove from buffer pool if present
-    m_Pages.erase(pageID);
-    m_LRU.remove(pageID);
+        lock.unlock();
+        frame.state.wait(state, std::memory_order_acquire);
+        lock.lock();
+    }
+    lock.unlock();
 
     // Free from disk and update freelist
     m_FileManager.freePage(pageID);
 }
+
+void BufferPool::movePage(uint32_t fromPageID, uint32_t toPageID)
+{
+    Page& src = fetchPage(fromPageID);
+    Page& dst = fetchPage(toPageID);
+
+    std::memcpy(dst.data(), src.data(), PAGE_SIZE);
+    dst.setPageID(toPageID);
+
+    markDirty(toPageID);
+    unpinPage(toPageID);
+    unpinPage(fromPageID);
+
+    freePage(fromPageID);
+}
@@ -14,9 +14,14 @@ void CLI::printHelp() const
 	std::cout << "Avaliable commands:\n"
 		<< "\tshow collections\n"
 		<< "\tcreate <collection>\n"
+		<< "\tdrop <collection>\n"
 		<< "\tinsert <collection> <key> <value>\n"
 		<< "\tget <collection> <key>\n"
 		<< "\tremove <collection> <key>\n"
+		<< "\tcompression\n"
+		<< "\tpoolstats\n"
+		<< "\tresize <frames>\n"
+		<< "\tshrink\n"
 		<< "\thelp\n"
 		<< "\texit\n";
 }
@@ -50,6 +55,21 @@ void CLI::handleCommand(const std::string& line)
 			std::cout << "Created collection: " << collection << "\n";
 		}
 	}
+	else if (cmd == "drop")
+	{
+		std::string collection;
+		iss >> collection;
+		if (collection.empty()) {
+			std::cout << "Usage: drop <collection>\n";
+			return;
+		}
+		if (!m_Engine.dropCollection(collection)) {
+			std::cout << "Collection " << collection << " not found.\n";
+		}
+		else {
+			std::cout << "Dropped collection: " << collection << "\n";
+		}
+	}
 	else if (cmd == "insert")
 	{
 		std::string collection, value;
@@ -96,6 +116,27 @@ void CLI::handleCommand(const std::string& line)
 			std::cout << "Key " << key << " not found.\n";
 		}
 	}
+	else if (cmd == "compression")
+	{
+		m_Engine.printCompressionStats();
+	}
+	else if (cmd == "poolstats")
+	{
+		m_Engine.printBufferPoolStats();
+	}
+	else if (cmd == "resize")
+	{
+		size_t frames;
+		if (!(iss >> frames)) {
+			std::cout << "Usage: resize <frames>\n";
+			return;
+		}
+		m_Engine.resizeBufferPool(frames);
+	}
+	else if (cmd == "shrink")
+	{
+		m_Engine.shrink();
+	}
 	else if (!cmd.empty()) 
 	{
 		std::cout << "Unknown command: " << cmd << "\n";
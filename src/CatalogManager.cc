@@ -31,6 +31,12 @@ CatalogManager::~CatalogManager() {
     }
 }
 
+void CatalogManager::flush() {
+    if (m_Dirty) {
+        saveCatalog();
+    }
+}
+
 
 void CatalogManager::createCollection(
     const std::string& name,
@@ -170,14 +176,13 @@ void CatalogManager::saveCatalog() {
             current = header->m_NextPageID;
         }
         else {
-            PageID newPage = m_BufferPool.allocatePage();
-            Page& newPg = m_BufferPool.fetchPage(newPage);
+            WritePageGuard guard = m_BufferPool.newPage();
+            PageID newPage = guard.pageID();
+            Page& newPg = guard.page();
             newPg.header()->m_Type = PageType::CATALOG;
             newPg.header()->m_PageID = newPage;
             newPg.header()->m_NextPageID = 0;
-            std::memset(newPg.payload(), 0, PAYLOAD_SIZE);
-            m_BufferPool.markDirty(newPage);
-            m_BufferPool.unpinPage(newPage);
+            guard.release();
 
 
             header->m_NextPageID = newPage;
@@ -199,6 +204,7 @@ void CatalogManager::updateCollectionMeta(
         if (entry.name == name) {
             entry.rootPageID = newRootPageID;
             entry.heapStartPageID = newHeapStartPageID;
+            m_Dirty = true;
             return;
         }
     }
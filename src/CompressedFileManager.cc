@@ -0,0 +1,466 @@
+#include "pebble/core/CompressedFileManager.h"
+#include "pebble/core/LzCodec.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace pebble::core;
+
+namespace {
+
+    constexpr uint8_t FULL_BUCKET = (1u << CompressedFileManager::SLOTS_PER_BUCKET) - 1;
+    constexpr size_t MAX_IMAGE_SIZE = CompressedFileManager::MAX_SLOT_CLASS * CompressedFileManager::SLOT_UNIT;
+
+    bool preadFull(int fd, char* buf, size_t size, off_t offset) {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = ::pread(fd, buf + done, size - done, offset + done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool pwriteFull(int fd, const char* buf, size_t size, off_t offset) {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = ::pwrite(fd, buf + done, size - done, offset + done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+}
+
+CompressedFileManager::CompressedFileManager(const std::string& filename)
+    : PosixFileManager(filename, true)
+{
+    std::vector<Page> mapPages;
+    for (uint32_t current = m_CompressionMapPageID; current != 0; ) {
+        Page page;
+        PosixFileManager::readPage(current, page);
+        current = page.header()->m_NextPageID;
+        mapPages.push_back(std::move(page));
+    }
+    m_Map.load(std::move(mapPages));
+
+    // Bucket occupancy is not stored, rebuild it from the map
+    m_Map.forEachCompressed([this](uint32_t pageID, const CompressionMap::Entry& entry) {
+        if (entry.slotClass > MAX_SLOT_CLASS || entry.slot >= SLOTS_PER_BUCKET || entry.length > MAX_IMAGE_SIZE) {
+            throw std::runtime_error("Corrupt compression map entry for page " + std::to_string(pageID));
+        }
+        m_Classes[entry.slotClass].used[entry.bucketPageID] |= static_cast<uint8_t>(1u << entry.slot);
+    });
+    for (SlotClass& cls : m_Classes) {
+        for (auto& [bucket, mask] : cls.used)
+            if (mask != FULL_BUCKET) cls.open.insert(bucket);
+    }
+}
+
+CompressedFileManager::~CompressedFileManager()
+{
+    // The base destructor can no longer reach collectDirtyMetadataPages(), persist the map here
+    try {
+        flush();
+    } catch (const std::exception& e) {
+        std::cerr << "CompressedFileManager: " << e.what() << "\n";
+    }
+}
+
+std::shared_lock<std::shared_mutex> CompressedFileManager::lockSlotsShared() const
+{
+    std::lock_guard<std::mutex> turn(m_SlotTurnstile);
+    return std::shared_lock<std::shared_mutex>(m_SlotMutex);
+}
+
+std::unique_lock<std::shared_mutex> CompressedFileManager::lockSlots()
+{
+    std::lock_guard<std::mutex> turn(m_SlotTurnstile);
+    return std::unique_lock<std::shared_mutex>(m_SlotMutex);
+}
+
+off_t CompressedFileManager::imageOffset(const CompressionMap::Entry& entry)
+{
+    return static_cast<off_t>(entry.bucketPageID) * PAGE_SIZE +
+           static_cast<off_t>(entry.slot) * entry.slotClass * SLOT_UNIT;
+}
+
+// Reads share m_SlotMutex: only a write may move a page between its own slot and a bucket
+void CompressedFileManager::readPage(uint32_t pageID, Page& page)
+{
+    std::shared_lock<std::shared_mutex> lock = lockSlotsShared();
+
+    CompressionMap::Entry entry = m_Map.get(pageID);
+    if (entry.slotClass == 0) {
+        PosixFileManager::readPage(pageID, page);
+        return;
+    }
+
+    char image[MAX_IMAGE_SIZE];
+    readImage(entry, image);
+
+    if (lzDecompress(image, entry.length, page.data(), PAGE_SIZE) != PAGE_SIZE) {
+        m_ChecksumFailures.fetch_add(1, std::memory_order_relaxed);
+        throw std::runtime_error("Corrupt compressed image for page " + std::to_string(pageID));
+    }
+
+    verifyChecksum(pageID, page);
+    page.setPageID(pageID);
+}
+
+void CompressedFileManager::writePage(const Page& page)
+{
+    std::unique_lock<std::shared_mutex> slotLock = lockSlots();
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    if (!writeCompressed(page)) {
+        PosixFileManager::writePage(page);
+        dropCompressed(page.getPageID());
+    }
+}
+
+void CompressedFileManager::writePages(std::vector<const Page*> pages)
+{
+    std::unique_lock<std::shared_mutex> slotLock = lockSlots();
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    std::vector<const Page*> inPlace;
+    for (const Page* page : pages) {
+        if (!writeCompressed(*page))
+            inPlace.push_back(page);
+    }
+
+    if (int err = writePageRuns(m_Fd, inPlace)) {
+        throw std::runtime_error(std::string("Failed to write page batch: ") + std::strerror(err));
+    }
+    for (const Page* page : inPlace)
+        dropCompressed(page->getPageID());
+}
+
+bool CompressedFileManager::writeCompressed(const Page& page)
+{
+    if (page.header()->m_Type != PageType::HEAP)
+        return false;
+
+    // The checksum covers the uncompressed page and is verified after decompression
+    page.stampChecksum();
+
+    char image[MAX_IMAGE_SIZE];
+    size_t length = lzCompress(page.data(), PAGE_SIZE, image, sizeof(image));
+    if (length == 0)
+        return false;
+
+    uint32_t pageID = page.getPageID();
+    uint8_t slotClass = static_cast<uint8_t>((length + SLOT_UNIT - 1) / SLOT_UNIT);
+
+    CompressionMap::Entry old = m_Map.get(pageID);
+    CompressionMap::Entry entry = old.slotClass == slotClass ? old : claimSlot(slotClass, pageID);
+    entry.length = static_cast<uint16_t>(length);
+
+    if (!pwriteFull(m_Fd, image, length, imageOffset(entry))) {
+        if (old.slotClass != slotClass)
+            releaseSlot(entry);
+        throw std::runtime_error("Failed to write compressed page " + std::to_string(pageID));
+    }
+
+    while (!m_Map.covers(pageID)) {
+        m_Map.addMapPage(allocateFromExtent(1));
+    }
+    m_Map.set(pageID, entry);
+
+    if (old.slotClass == 0)
+        m_PendingHoles.insert(pageID);
+    else if (old.slotClass != slotClass)
+        m_PendingSlots.push_back(old);
+
+    return true;
+}
+
+void CompressedFileManager::dropCompressed(uint32_t pageID)
+{
+    m_PendingHoles.erase(pageID);
+
+    CompressionMap::Entry entry = m_Map.get(pageID);
+    if (entry.slotClass == 0)
+        return;
+
+    m_Map.set(pageID, CompressionMap::Entry{});
+    m_PendingSlots.push_back(entry);
+}
+
+// The base blanks reused pages through writePages(), which would take m_SlotMutex after
+// m_RecMutex. Take both in order here and blank them in place: a free page has no image.
+uint32_t CompressedFileManager::allocatePages(uint32_t count, uint32_t nearPageID)
+{
+    std::unique_lock<std::shared_mutex> slotLock = lockSlots();
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    uint32_t end = m_NextPageID;
+    uint32_t first = PosixFileManager::allocatePagesUnwritten(count, nearPageID);
+    if (first >= end)
+        return first;       // fresh pages from the extent read back as zeros
+
+    std::vector<Page> blanks(count);
+    std::vector<const Page*> batch;
+    for (uint32_t i = 0; i < count; ++i) {
+        blanks[i].setPageID(first + i);
+        batch.push_back(&blanks[i]);
+    }
+    if (int err = writePageRuns(m_Fd, batch)) {
+        throw std::runtime_error(std::string("Failed to blank reused pages: ") + std::strerror(err));
+    }
+    return first;
+}
+
+void CompressedFileManager::freePage(uint32_t pageID)
+{
+    std::unique_lock<std::shared_mutex> slotLock = lockSlots();
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    // Its own slot stays a (pending) hole until the page is reused
+    CompressionMap::Entry entry = m_Map.get(pageID);
+    if (entry.slotClass != 0) {
+        m_Map.set(pageID, CompressionMap::Entry{});
+        m_PendingSlots.push_back(entry);
+    }
+
+    PosixFileManager::freePage(pageID);
+}
+
+// Slots released by writes since the last flush become reusable once the map is durable. A bucket
+// that empties out frees its pages, which takes one more flush to record.
+void CompressedFileManager::flush()
+{
+    std::unique_lock<std::shared_mutex> slotLock = lockSlots();
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    PosixFileManager::flush();
+    if (releasePendingSlots())
+        PosixFileManager::flush();
+}
+
+// Images in the highest buckets move to the lowest open slot of their class first, so the
+// buckets at the end of the file empty out and the base can cut them off
+uint32_t CompressedFileManager::shrink()
+{
+    std::unique_lock<std::shared_mutex> slotLock = lockSlots();
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    std::vector<std::pair<uint32_t, CompressionMap::Entry>> images;
+    m_Map.forEachCompressed([&](uint32_t pageID, const CompressionMap::Entry& entry) {
+        images.emplace_back(pageID, entry);
+    });
+    std::sort(images.begin(), images.end(), [](const auto& a, const auto& b) {
+        return a.second.bucketPageID > b.second.bucketPageID;
+    });
+
+    std::array<bool, MAX_SLOT_CLASS + 1> settled{};
+    for (auto& [pageID, entry] : images) {
+        if (settled[entry.slotClass])
+            continue;
+
+        CompressionMap::Entry target = claimSlot(entry.slotClass, 0);
+        if (target.bucketPageID >= entry.bucketPageID) {
+            // No open bucket below this one, try a fresh bucket in a lower free run
+            releaseSlot(target);
+            target = openBucket(entry.slotClass, 0);
+        }
+        if (target.bucketPageID >= entry.bucketPageID) {
+            releaseSlot(target);
+            settled[entry.slotClass] = true;        // nothing lower left for this class
+            continue;
+        }
+
+        char image[MAX_IMAGE_SIZE];
+        readImage(entry, image);
+        if (!pwriteFull(m_Fd, image, entry.length, imageOffset(target))) {
+            releaseSlot(target);
+            throw std::runtime_error("Failed to move compressed page " + std::to_string(pageID));
+        }
+
+        target.length = entry.length;
+        m_Map.set(pageID, target);
+        m_PendingSlots.push_back(entry);
+    }
+
+    // The vacated buckets are only freed once the map pointing below them is durable
+    PosixFileManager::flush();
+    releasePendingSlots();
+    return PosixFileManager::shrink();
+}
+
+CompressionMap::Entry CompressedFileManager::claimSlot(uint8_t slotClass, uint32_t nearPageID)
+{
+    SlotClass& cls = m_Classes[slotClass];
+    if (cls.open.empty())
+        return openBucket(slotClass, nearPageID);
+
+    CompressionMap::Entry entry;
+    entry.slotClass = slotClass;
+
+    // Prefer the open bucket closest after the page, keeping scans of a heap chain local
+    auto it = cls.open.lower_bound(nearPageID);
+    if (it == cls.open.end())
+        it = std::prev(it);
+
+    uint8_t& mask = cls.used[*it];
+    entry.bucketPageID = *it;
+    entry.slot = static_cast<uint8_t>(std::countr_one(mask));
+    mask |= static_cast<uint8_t>(1u << entry.slot);
+    if (mask == FULL_BUCKET)
+        cls.open.erase(it);
+
+    return entry;
+}
+
+CompressionMap::Entry CompressedFileManager::openBucket(uint8_t slotClass, uint32_t nearPageID)
+{
+    SlotClass& cls = m_Classes[slotClass];
+
+    CompressionMap::Entry entry;
+    entry.slotClass = slotClass;
+    entry.bucketPageID = PosixFileManager::allocatePagesUnwritten(slotClass, nearPageID);     // slots are written whole
+    entry.slot = 0;
+    cls.used[entry.bucketPageID] = 1;
+    cls.open.insert(entry.bucketPageID);
+    return entry;
+}
+
+bool CompressedFileManager::releaseSlot(const CompressionMap::Entry& entry)
+{
+    SlotClass& cls = m_Classes[entry.slotClass];
+    auto it = cls.used.find(entry.bucketPageID);
+    if (it == cls.used.end())
+        return false;
+
+    it->second &= static_cast<uint8_t>(~(1u << entry.slot));
+    if (it->second != 0) {
+        cls.open.insert(entry.bucketPageID);
+        return false;
+    }
+
+    // Empty bucket: hand its pages back and reclaim their space once the map is flushed
+    cls.used.erase(it);
+    cls.open.erase(entry.bucketPageID);
+    for (uint32_t i = 0; i < entry.slotClass; ++i) {
+        PosixFileManager::freePage(entry.bucketPageID + i);
+    }
+    return true;
+}
+
+bool CompressedFileManager::releasePendingSlots()
+{
+    bool freedBucket = false;
+    for (const CompressionMap::Entry& entry : m_PendingSlots)
+        freedBucket |= releaseSlot(entry);
+    m_PendingSlots.clear();
+    return freedBucket;
+}
+
+void CompressedFileManager::readImage(const CompressionMap::Entry& entry, char* buf) const
+{
+    if (!preadFull(m_Fd, buf, entry.length, imageOffset(entry))) {
+        throw std::runtime_error("Failed to read compressed image in bucket " + std::to_string(entry.bucketPageID));
+    }
+}
+
+void CompressedFileManager::collectDirtyMetadataPages(std::vector<const Page*>& pages)
+{
+    std::vector<const Page*> dirty = m_Map.takeDirtyPages();
+    pages.insert(pages.end(), dirty.begin(), dirty.end());
+    m_CompressionMapPageID = m_Map.headPageID();
+}
+
+bool CompressedFileManager::relocateMetadataPage(uint32_t fromPageID, uint32_t toPageID)
+{
+    // Buckets are not moved here: they drain as the pages stored in them are rewritten or freed
+    return m_Map.relocateMapPage(fromPageID, toPageID) || PosixFileManager::relocateMetadataPage(fromPageID, toPageID);
+}
+
+void CompressedFileManager::prefetch(std::span<const uint32_t> pageIDs)
+{
+    std::vector<uint32_t> inPlace;
+    {
+        std::shared_lock<std::shared_mutex> lock = lockSlotsShared();
+        for (uint32_t pageID : pageIDs) {
+            CompressionMap::Entry entry = m_Map.get(pageID);
+            if (entry.slotClass == 0) {
+                inPlace.push_back(pageID);
+                continue;
+            }
+#ifdef POSIX_FADV_WILLNEED
+            ::posix_fadvise(m_Fd, imageOffset(entry), entry.length, POSIX_FADV_WILLNEED);
+#endif
+        }
+    }
+
+    PosixFileManager::prefetch(inPlace);
+}
+
+std::optional<CompressionStats> CompressedFileManager::compressionStats(std::span<const uint32_t> pageIDs)
+{
+    using Clock = std::chrono::steady_clock;
+
+    CompressionStats stats;
+    Clock::duration compressTime{}, decompressTime{};
+    uint64_t decompressedBytes = 0;
+
+    Page page;
+    char image[MAX_IMAGE_SIZE];
+    char scratch[MAX_IMAGE_SIZE];
+
+    for (uint32_t pageID : pageIDs) {
+        stats.pages++;
+        stats.logicalBytes += PAGE_SIZE;
+
+        {
+            std::shared_lock<std::shared_mutex> lock = lockSlotsShared();
+            CompressionMap::Entry entry = m_Map.get(pageID);
+
+            if (entry.slotClass == 0) {
+                stats.storedBytes += PAGE_SIZE;
+                PosixFileManager::readPage(pageID, page);
+            }
+            else {
+                stats.compressedPages++;
+                stats.storedBytes += entry.length;
+                readImage(entry, image);
+
+                auto t0 = Clock::now();
+                size_t n = lzDecompress(image, entry.length, page.data(), PAGE_SIZE);
+                decompressTime += Clock::now() - t0;
+                if (n != PAGE_SIZE) {
+                    throw std::runtime_error("Corrupt compressed image for page " + std::to_string(pageID));
+                }
+                decompressedBytes += PAGE_SIZE;
+            }
+        }
+
+        // Recompress to time the write side on this data
+        auto t0 = Clock::now();
+        lzCompress(page.data(), PAGE_SIZE, scratch, sizeof(scratch));
+        compressTime += Clock::now() - t0;
+    }
+
+    auto mbps = [](uint64_t bytes, Clock::duration elapsed) {
+        double secs = std::chrono::duration<double>(elapsed).count();
+        return secs > 0 ? bytes / (1024.0 * 1024.0) / secs : 0.0;
+    };
+    stats.compressMBps = mbps(stats.logicalBytes, compressTime);
+    stats.decompressMBps = mbps(decompressedBytes, decompressTime);
+
+    return stats;
+}
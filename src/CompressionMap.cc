@@ -0,0 +1,96 @@
+#include "pebble/core/CompressionMap.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace pebble::core;
+
+void CompressionMap::load(std::vector<Page> mapPages)
+{
+    m_MapPages = std::move(mapPages);
+    m_Dirty.assign(m_MapPages.size(), false);
+}
+
+uint32_t CompressionMap::headPageID() const
+{
+    return m_MapPages.empty() ? 0 : m_MapPages.front().getPageID();
+}
+
+bool CompressionMap::covers(uint32_t pageID) const
+{
+    return pageID < static_cast<uint64_t>(m_MapPages.size()) * ENTRIES_PER_MAP_PAGE;
+}
+
+void CompressionMap::addMapPage(uint32_t mapPageID)
+{
+    Page page;
+    page.header()->m_Type = PageType::COMPRESSION_MAP;
+    page.setPageID(mapPageID);
+
+    if (!m_MapPages.empty()) {
+        m_MapPages.back().header()->m_NextPageID = mapPageID;
+        m_Dirty.back() = true;
+    }
+
+    m_MapPages.push_back(std::move(page));
+    m_Dirty.push_back(true);
+}
+
+CompressionMap::Entry CompressionMap::get(uint32_t pageID) const
+{
+    Entry entry;
+    if (covers(pageID)) {
+        const Page& page = m_MapPages[pageID / ENTRIES_PER_MAP_PAGE];
+        std::memcpy(&entry, page.payload() + (pageID % ENTRIES_PER_MAP_PAGE) * sizeof(Entry), sizeof(Entry));
+    }
+    return entry;
+}
+
+void CompressionMap::set(uint32_t pageID, const Entry& entry)
+{
+    if (!covers(pageID))
+        throw std::out_of_range("Page " + std::to_string(pageID) + " not covered by the compression map");
+
+    size_t mapIdx = pageID / ENTRIES_PER_MAP_PAGE;
+    std::memcpy(m_MapPages[mapIdx].payload() + (pageID % ENTRIES_PER_MAP_PAGE) * sizeof(Entry), &entry, sizeof(Entry));
+    m_Dirty[mapIdx] = true;
+}
+
+bool CompressionMap::relocateMapPage(uint32_t fromPageID, uint32_t toPageID)
+{
+    for (size_t i = 0; i < m_MapPages.size(); ++i) {
+        if (m_MapPages[i].getPageID() != fromPageID)
+            continue;
+
+        m_MapPages[i].setPageID(toPageID);
+        m_Dirty[i] = true;
+        if (i > 0) {
+            m_MapPages[i - 1].header()->m_NextPageID = toPageID;
+            m_Dirty[i - 1] = true;
+        }
+        return true;
+    }
+    return false;
+}
+
+std::vector<const Page*> CompressionMap::takeDirtyPages()
+{
+    std::vector<const Page*> dirty;
+    for (size_t i = 0; i < m_MapPages.size(); ++i) {
+        if (m_Dirty[i]) {
+            dirty.push_back(&m_MapPages[i]);
+            m_Dirty[i] = false;
+        }
+    }
+    return dirty;
+}
+
+void CompressionMap::forEachCompressed(const std::function<void(uint32_t pageID, const Entry& entry)>& visitor) const
+{
+    uint64_t total = static_cast<uint64_t>(m_MapPages.size()) * ENTRIES_PER_MAP_PAGE;
+    for (uint64_t pageID = 0; pageID < total; ++pageID) {
+        Entry entry = get(static_cast<uint32_t>(pageID));
+        if (entry.slotClass != 0)
+            visitor(static_cast<uint32_t>(pageID), entry);
+    }
+}
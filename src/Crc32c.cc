@@ -0,0 +1,210 @@
+#include "pebble/core/Crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PEBBLE_CRC32C_SSE42 1
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define PEBBLE_CRC32C_ARMV8 1
+#include <arm_acle.h>
+#endif
+
+using namespace pebble::core;
+
+namespace {
+
+    constexpr uint32_t POLY = 0x82F63B78;       // reflected Castagnoli polynomial
+
+    using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+    constexpr Tables makeTables() {
+        Tables t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c >> 1) ^ (POLY & (0u - (c & 1)));
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i)
+            for (size_t s = 1; s < 8; ++s)
+                t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+        return t;
+    }
+
+    constexpr Tables TABLES = makeTables();
+
+    // All variants work on the raw register value (no pre/post inversion)
+    uint32_t extendPortable(uint32_t c, const uint8_t* p, size_t n) {
+        while (n >= 8) {
+            uint32_t lo, hi;
+            std::memcpy(&lo, p, 4);
+            std::memcpy(&hi, p + 4, 4);
+            lo ^= c;        // little-endian layout assumed, as everywhere else in the page format
+            c = TABLES[7][lo & 0xFF] ^ TABLES[6][(lo >> 8) & 0xFF] ^
+                TABLES[5][(lo >> 16) & 0xFF] ^ TABLES[4][lo >> 24] ^
+                TABLES[3][hi & 0xFF] ^ TABLES[2][(hi >> 8) & 0xFF] ^
+                TABLES[1][(hi >> 16) & 0xFF] ^ TABLES[0][hi >> 24];
+            p += 8;
+            n -= 8;
+        }
+        while (n--)
+            c = (c >> 8) ^ TABLES[0][(c ^ *p++) & 0xFF];
+        return c;
+    }
+
+    // ------------------------------------------------------------------------------------------
+    // The CRC instruction has a 3 cycle latency but issues every cycle, so the hardware paths run
+    // three independent streams over consecutive BLOCK-byte chunks and merge them. CRC is linear:
+    //     crc(c, A || B) = shift(crc(c, A), |B|) ^ crc(0, B)
+    // where shift() multiplies by x^(8|B|) mod P, a 32-bit linear map applied with byte tables.
+
+    constexpr size_t BLOCK = 256;
+
+    // a * b mod P, in the reflected bit order
+    constexpr uint32_t multModP(uint32_t a, uint32_t b) {
+        uint32_t product = 0;
+        for (uint32_t m = 1u << 31; m != 0; m >>= 1) {
+            if (a & m)
+                product ^= b;
+            b = (b >> 1) ^ (POLY & (0u - (b & 1)));
+        }
+        return product;
+    }
+
+    using ShiftTable = std::array<std::array<uint32_t, 256>, 4>;
+
+    constexpr ShiftTable makeShiftTable(size_t bytes) {
+        uint32_t xn = 1u << 31;                             // x^0
+        for (size_t i = 0; i < bytes * 8; ++i)
+            xn = (xn >> 1) ^ (POLY & (0u - (xn & 1)));      // * x
+
+        ShiftTable t{};
+        for (uint32_t k = 0; k < 4; ++k)
+            for (uint32_t v = 0; v < 256; ++v)
+                t[k][v] = multModP(xn, v << (8 * k));
+        return t;
+    }
+
+    [[maybe_unused]] constexpr ShiftTable SHIFT_1 = makeShiftTable(BLOCK);
+    [[maybe_unused]] constexpr ShiftTable SHIFT_2 = makeShiftTable(2 * BLOCK);
+
+    [[maybe_unused]] inline uint32_t shift(const ShiftTable& t, uint32_t c) {
+        return t[0][c & 0xFF] ^ t[1][(c >> 8) & 0xFF] ^ t[2][(c >> 16) & 0xFF] ^ t[3][c >> 24];
+    }
+
+#if defined(PEBBLE_CRC32C_SSE42) && defined(__x86_64__)
+    __attribute__((target("sse4.2")))
+    uint32_t extendHardware(uint32_t c, const uint8_t* p, size_t n) {
+        while (n >= 3 * BLOCK) {
+            uint64_t c0 = c, c1 = 0, c2 = 0;
+            for (size_t i = 0; i < BLOCK; i += 8) {
+                uint64_t v0, v1, v2;
+                std::memcpy(&v0, p + i, 8);
+                std::memcpy(&v1, p + BLOCK + i, 8);
+                std::memcpy(&v2, p + 2 * BLOCK + i, 8);
+                c0 = _mm_crc32_u64(c0, v0);
+                c1 = _mm_crc32_u64(c1, v1);
+                c2 = _mm_crc32_u64(c2, v2);
+            }
+            c = shift(SHIFT_2, static_cast<uint32_t>(c0)) ^ shift(SHIFT_1, static_cast<uint32_t>(c1)) ^ static_cast<uint32_t>(c2);
+            p += 3 * BLOCK;
+            n -= 3 * BLOCK;
+        }
+        while (n >= 8) {
+            uint64_t v;
+            std::memcpy(&v, p, 8);
+            c = static_cast<uint32_t>(_mm_crc32_u64(c, v));
+            p += 8;
+            n -= 8;
+        }
+        while (n--)
+            c = _mm_crc32_u8(c, *p++);
+        return c;
+    }
+
+    bool detectHardware() {
+        return __builtin_cpu_supports("sse4.2");
+    }
+#elif defined(PEBBLE_CRC32C_SSE42)
+    __attribute__((target("sse4.2")))
+    uint32_t extendHardware(uint32_t c, const uint8_t* p, size_t n) {
+        while (n >= 4) {
+            uint32_t v;
+            std::memcpy(&v, p, 4);
+            c = _mm_crc32_u32(c, v);
+            p += 4;
+            n -= 4;
+        }
+        while (n--)
+            c = _mm_crc32_u8(c, *p++);
+        return c;
+    }
+
+    bool detectHardware() {
+        return __builtin_cpu_supports("sse4.2");
+    }
+#elif defined(PEBBLE_CRC32C_ARMV8)
+    uint32_t extendHardware(uint32_t c, const uint8_t* p, size_t n) {
+        while (n >= 3 * BLOCK) {
+            uint32_t c0 = c, c1 = 0, c2 = 0;
+            for (size_t i = 0; i < BLOCK; i += 8) {
+                uint64_t v0, v1, v2;
+                std::memcpy(&v0, p + i, 8);
+                std::memcpy(&v1, p + BLOCK + i, 8);
+                std::memcpy(&v2, p + 2 * BLOCK + i, 8);
+                c0 = __crc32cd(c0, v0);
+                c1 = __crc32cd(c1, v1);
+                c2 = __crc32cd(c2, v2);
+            }
+            c = shift(SHIFT_2, c0) ^ shift(SHIFT_1, c1) ^ c2;
+            p += 3 * BLOCK;
+            n -= 3 * BLOCK;
+        }
+        while (n >= 8) {
+            uint64_t v;
+            std::memcpy(&v, p, 8);
+            c = __crc32cd(c, v);
+            p += 8;
+            n -= 8;
+        }
+        while (n--)
+            c = __crc32cb(c, *p++);
+        return c;
+    }
+
+    // The compiler was allowed to assume the CRC extension (-march=armv8-a+crc and up)
+    bool detectHardware() {
+        return true;
+    }
+#else
+    uint32_t extendHardware(uint32_t c, const uint8_t* p, size_t n) {
+        return extendPortable(c, p, n);
+    }
+
+    bool detectHardware() {
+        return false;
+    }
+#endif
+
+    const bool HAS_HARDWARE = detectHardware();
+
+}
+
+uint32_t pebble::core::crc32c(const void* data, size_t size, uint32_t crc)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t c = HAS_HARDWARE ? extendHardware(~crc, p, size) : extendPortable(~crc, p, size);
+    return ~c;
+}
+
+uint32_t pebble::core::crc32cPortable(const void* data, size_t size, uint32_t crc)
+{
+    return ~extendPortable(~crc, static_cast<const uint8_t*>(data), size);
+}
+
+bool pebble::core::crc32cHardwareAccelerated()
+{
+    return HAS_HARDWARE;
+}
@@ -0,0 +1,105 @@
+#include "pebble/core/DirectFileManager.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+using namespace pebble::core;
+
+DirectFileManager::DirectFileManager(const std::string& filename)
+    : PosixFileManager(filename)
+{
+#ifdef O_DIRECT
+    m_DirectFd = ::open(filename.c_str(), O_RDWR | O_DIRECT);
+    if (m_DirectFd < 0) {
+        disableDirectIO(std::strerror(errno));
+        return;
+    }
+    m_Direct = true;
+#else
+    disableDirectIO("not supported on this platform");
+#endif
+}
+
+void DirectFileManager::disableDirectIO(const char* reason)
+{
+    // The descriptor stays open until destruction, a concurrent transfer may still be using it
+    if (m_Direct.exchange(false) || m_DirectFd < 0) {
+        std::cerr << "O_DIRECT unavailable for " << m_Filename << " (" << reason << "), using buffered I/O\n";
+    }
+}
+
+DirectFileManager::~DirectFileManager()
+{
+    if (m_DirectFd >= 0) {
+        ::close(m_DirectFd);
+    }
+}
+
+void DirectFileManager::readPage(uint32_t pageID, Page& page)
+{
+    if (!usingDirectIO()) {
+        PosixFileManager::readPage(pageID, page);
+        return;
+    }
+
+    // Page buffers are PAGE_ALIGNMENT aligned and PAGE_SIZE long, as O_DIRECT requires
+    ssize_t n;
+    do {
+        n = ::pread(m_DirectFd, page.data(), PAGE_SIZE, static_cast<off_t>(pageID) * PAGE_SIZE);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0 && errno == EINVAL) {
+        disableDirectIO(std::strerror(errno));
+        PosixFileManager::readPage(pageID, page);
+        return;
+    }
+    if (n != static_cast<ssize_t>(PAGE_SIZE)) {
+        throw std::runtime_error("Failed to read page " + std::to_string(pageID) +
+                                 " (read " + std::to_string(n < 0 ? 0 : n) + " bytes)");
+    }
+
+    verifyChecksum(pageID, page);
+    page.setPageID(pageID);
+}
+
+void DirectFileManager::writePage(const Page& page)
+{
+    if (!usingDirectIO()) {
+        PosixFileManager::writePage(page);
+        return;
+    }
+
+    page.stampChecksum();
+
+    ssize_t n;
+    do {
+        n = ::pwrite(m_DirectFd, page.data(), PAGE_SIZE, static_cast<off_t>(page.getPageID()) * PAGE_SIZE);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0 && errno == EINVAL) {
+        disableDirectIO(std::strerror(errno));
+        PosixFileManager::writePage(page);
+        return;
+    }
+    if (n != static_cast<ssize_t>(PAGE_SIZE)) {
+        throw std::runtime_error("Failed to write page " + std::to_string(page.getPageID()));
+    }
+}
+
+void DirectFileManager::writePages(std::vector<const Page*> pages)
+{
+    int err = EINVAL;
+    if (usingDirectIO()) {
+        err = writePageRuns(m_DirectFd, pages);
+        if (err == EINVAL)
+            disableDirectIO(std::strerror(err));
+    }
+    if (err == EINVAL)
+        err = writePageRuns(m_Fd, pages);
+
+    if (err) {
+        throw std::runtime_error(std::string("Failed to write page batch: ") + std::strerror(err));
+    }
+}
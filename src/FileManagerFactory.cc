@@ -0,0 +1,63 @@
+#include "pebble/core/FileManagerFactory.h"
+
+#ifdef _WIN32
+#include "pebble/core/WindowsFileManager.h"
+#else
+#include "pebble/core/PosixFileManager.h"
+#include "pebble/core/MmapFileManager.h"
+#include "pebble/core/DirectFileManager.h"
+#include "pebble/core/CompressedFileManager.h"
+#endif
+
+#ifdef __linux__
+#include "pebble/core/IoUringFileManager.h"
+#endif
+
+#include <stdexcept>
+
+using namespace pebble::core;
+
+FileManagerType pebble::core::defaultFileManagerType()
+{
+#ifdef _WIN32
+    return FileManagerType::WINDOWS;
+#else
+    return FileManagerType::POSIX;
+#endif
+}
+
+std::optional<FileManagerType> pebble::core::parseFileManagerType(const std::string& name)
+{
+    if (name == "posix")   return FileManagerType::POSIX;
+    if (name == "windows") return FileManagerType::WINDOWS;
+    if (name == "io_uring") return FileManagerType::IO_URING;
+    if (name == "mmap")    return FileManagerType::MMAP;
+    if (name == "direct")  return FileManagerType::DIRECT;
+    if (name == "compressed") return FileManagerType::COMPRESSED;
+    return std::nullopt;
+}
+
+std::unique_ptr<IFileManager> pebble::core::createFileManager(FileManagerType type, const std::string& filename)
+{
+    switch (type) {
+#ifdef _WIN32
+        case FileManagerType::WINDOWS:
+            return std::make_unique<WindowsFileManager>(filename);
+#else
+        case FileManagerType::POSIX:
+            return std::make_unique<PosixFileManager>(filename);
+        case FileManagerType::MMAP:
+            return std::make_unique<MmapFileManager>(filename);
+        case FileManagerType::DIRECT:
+            return std::make_unique<DirectFileManager>(filename);
+        case FileManagerType::COMPRESSED:
+            return std::make_unique<CompressedFileManager>(filename);
+#endif
+#ifdef __linux__
+        case FileManagerType::IO_URING:
+            return std::make_unique<IoUringFileManager>(filename);
+#endif
+        default:
+            throw std::invalid_argument("File manager backend not available on this platform");
+    }
+}
@@ -0,0 +1,203 @@
+#include "pebble/core/FreeSpaceMap.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+using namespace pebble::core;
+
+void FreeSpaceMap::load(std::vector<Page> mapPages)
+{
+    m_MapPages = std::move(mapPages);
+    m_Dirty.assign(m_MapPages.size(), false);
+
+    m_FreePages = 0;
+    for (uint64_t w = 0; w < totalBits() / 64; ++w)
+        m_FreePages += std::popcount(word(w));
+}
+
+uint32_t FreeSpaceMap::headPageID() const
+{
+    return m_MapPages.empty() ? 0 : m_MapPages.front().getPageID();
+}
+
+bool FreeSpaceMap::covers(uint32_t pageID) const
+{
+    return pageID < totalBits();
+}
+
+void FreeSpaceMap::addMapPage(uint32_t mapPageID)
+{
+    Page page;
+    page.header()->m_Type = PageType::FREE_MAP;
+    page.setPageID(mapPageID);
+
+    if (!m_MapPages.empty()) {
+        m_MapPages.back().header()->m_NextPageID = mapPageID;
+        m_Dirty.back() = true;
+    }
+
+    m_MapPages.push_back(std::move(page));
+    m_Dirty.push_back(true);
+}
+
+uint64_t FreeSpaceMap::word(uint64_t wordIdx) const
+{
+    uint64_t w;
+    const Page& page = m_MapPages[wordIdx / WORDS_PER_MAP_PAGE];
+    std::memcpy(&w, page.payload() + (wordIdx % WORDS_PER_MAP_PAGE) * sizeof(uint64_t), sizeof(uint64_t));
+    return w;
+}
+
+void FreeSpaceMap::setWord(uint64_t wordIdx, uint64_t value)
+{
+    size_t mapIdx = wordIdx / WORDS_PER_MAP_PAGE;
+    std::memcpy(m_MapPages[mapIdx].payload() + (wordIdx % WORDS_PER_MAP_PAGE) * sizeof(uint64_t), &value, sizeof(uint64_t));
+    m_Dirty[mapIdx] = true;
+}
+
+bool FreeSpaceMap::isFree(uint32_t pageID) const
+{
+    return covers(pageID) && (word(pageID / 64) >> (pageID % 64) & 1);
+}
+
+void FreeSpaceMap::markFree(uint32_t pageID)
+{
+    if (!covers(pageID))
+        throw std::out_of_range("Page " + std::to_string(pageID) + " not covered by the free-space map");
+    if (isFree(pageID))
+        return;
+
+    setWord(pageID / 64, word(pageID / 64) | (uint64_t(1) << (pageID % 64)));
+    m_FreePages++;
+}
+
+void FreeSpaceMap::truncate(uint32_t endPageID)
+{
+    for (uint64_t bit = endPageID; bit < totalBits(); ++bit) {
+        if (bit % 64 == 0 && word(bit / 64) == 0) {
+            bit += 63;                                          // nothing free in this word
+            continue;
+        }
+        if (isFree(static_cast<uint32_t>(bit))) {
+            setWord(bit / 64, word(bit / 64) & ~(uint64_t(1) << (bit % 64)));
+            m_FreePages--;
+        }
+    }
+}
+
+bool FreeSpaceMap::relocateMapPage(uint32_t fromPageID, uint32_t toPageID)
+{
+    for (size_t i = 0; i < m_MapPages.size(); ++i) {
+        if (m_MapPages[i].getPageID() != fromPageID)
+            continue;
+
+        m_MapPages[i].setPageID(toPageID);
+        m_Dirty[i] = true;
+        if (i > 0) {
+            m_MapPages[i - 1].header()->m_NextPageID = toPageID;
+            m_Dirty[i - 1] = true;
+        }
+        return true;
+    }
+    return false;
+}
+
+std::optional<uint64_t> FreeSpaceMap::findRun(uint64_t begin, uint64_t end, uint32_t count) const
+{
+    uint64_t bit = begin;
+    uint64_t runStart = 0;
+    uint64_t runLen = 0;
+
+    // Runs must start in [begin, end) but may extend past end
+    while (bit < totalBits()) {
+        uint64_t w = word(bit / 64) >> (bit % 64);
+        unsigned avail = 64 - static_cast<unsigned>(bit % 64);
+
+        if (runLen == 0) {
+            if (w == 0) {
+                bit += avail;                                   // whole word allocated
+                if (bit >= end) break;
+                continue;
+            }
+            unsigned skip = std::countr_zero(w);
+            bit += skip;
+            w >>= skip;
+            avail -= skip;
+            if (bit >= end) break;
+            runStart = bit;
+        }
+
+        unsigned ones = std::min<unsigned>(std::countr_one(w), avail);
+        runLen += ones;
+        if (runLen >= count)
+            return runStart;
+
+        bit += ones;
+        if (ones < avail)
+            runLen = 0;                                         // run broken by an allocated page
+    }
+
+    return std::nullopt;
+}
+
+void FreeSpaceMap::claim(uint64_t first, uint32_t count)
+{
+    for (uint64_t bit = first; bit < first + count; ++bit)
+        setWord(bit / 64, word(bit / 64) & ~(uint64_t(1) << (bit % 64)));
+
+    m_FreePages -= count;
+}
+
+std::optional<uint32_t> FreeSpaceMap::allocate(uint32_t count, uint32_t nearPageID)
+{
+    if (count == 0 || m_FreePages < count)
+        return std::nullopt;
+
+    uint64_t near = std::min<uint64_t>(nearPageID, totalBits());
+
+    auto first = findRun(near, totalBits(), count);
+    if (!first && near > 0)
+        first = findRun(0, near, count);
+    if (!first)
+        return std::nullopt;
+
+    claim(*first, count);
+    return static_cast<uint32_t>(*first);
+}
+
+std::vector<const Page*> FreeSpaceMap::takeDirtyPages()
+{
+    std::vector<const Page*> dirty;
+    for (size_t i = 0; i < m_MapPages.size(); ++i) {
+        if (m_Dirty[i]) {
+            dirty.push_back(&m_MapPages[i]);
+            m_Dirty[i] = false;
+        }
+    }
+    return dirty;
+}
+
+void FreeSpaceMap::forEachFreeRun(const std::function<void(uint32_t first, uint32_t count)>& visitor) const
+{
+    uint64_t runStart = 0;
+    uint64_t runLen = 0;
+
+    for (uint64_t bit = 0; bit < totalBits(); ++bit) {
+        if (bit % 64 == 0 && runLen == 0 && word(bit / 64) == 0) {
+            bit += 63;                                          // skip fully allocated words
+            continue;
+        }
+
+        if (word(bit / 64) >> (bit % 64) & 1) {
+            if (runLen++ == 0) runStart = bit;
+        }
+        else if (runLen > 0) {
+            visitor(static_cast<uint32_t>(runStart), static_cast<uint32_t>(runLen));
+            runLen = 0;
+        }
+    }
+
+    if (runLen > 0)
+        visitor(static_cast<uint32_t>(runStart), static_cast<uint32_t>(runLen));
+}
@@ -1,6 +1,9 @@
 #include "pebble/core/HeapFile.h"
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
+#include <span>
+#include <utility>
 
 using namespace pebble::core;
 
@@ -14,9 +17,8 @@ HeapFile::HeapFile(const std::string& name, BufferPool& bp, PageID startPageID)
     PageID curr = startPageID;
     while (curr != 0 && curr != static_cast<PageID>(-1)) {
         m_Pages.push_back(curr);
-        Page& page = m_BufferPool.fetchPage(curr);
-        m_BufferPool.unpinPage(curr);
-        curr = page.header()->m_NextPageID;
+        ReadPageGuard guard = m_BufferPool.fetchPageRead(curr);
+        curr = guard.page().header()->m_NextPageID;
     }
 }
 
@@ -24,8 +26,9 @@ HeapFile::HeapFile(const std::string& name, BufferPool& bp, PageID startPageID)
 HeapFile::HeapFile(const std::string& name, BufferPool& bp)
     : m_Name(name), m_BufferPool(bp)
 {
-    PageID pageID = m_BufferPool.allocatePage();
-    Page& page = m_BufferPool.fetchPage(pageID);
+    WritePageGuard guard = m_BufferPool.newPage();
+    PageID pageID = guard.pageID();
+    Page& page = guard.page();
 
 	m_StartPageID = pageID;
 
@@ -33,9 +36,6 @@ HeapFile::HeapFile(const std::string& name, BufferPool& bp)
     page.header()->m_PageID = pageID;
     page.header()->m_NextPageID = 0;
 
-    m_BufferPool.markDirty(pageID);
-    m_BufferPool.unpinPage(pageID);
-
     m_Pages.push_back(pageID);
 }
 
@@ -43,6 +43,37 @@ uint32_t HeapFile::getStartPageID() const {
     return m_StartPageID;
 }
 
+void HeapFile::relocate(const std::unordered_map<PageID, PageID>& moved)
+{
+    auto newID = [&](PageID pageID) {
+        auto it = moved.find(pageID);
+        return it == moved.end() ? pageID : it->second;
+    };
+
+    for (size_t i = 0; i < m_Pages.size(); ++i) {
+        PageID pageID = newID(m_Pages[i]);
+
+        // The predecessor (already renamed) must point at the new ID
+        if (i > 0 && pageID != m_Pages[i]) {
+            WritePageGuard prev = m_BufferPool.fetchPageWrite(m_Pages[i - 1]);
+            prev.page().header()->m_NextPageID = pageID;
+        }
+        m_Pages[i] = pageID;
+    }
+
+    m_StartPageID = newID(m_StartPageID);
+}
+
+uint64_t HeapFile::relocateRecordID(uint64_t recordID, const std::unordered_map<PageID, PageID>& moved) const
+{
+    PageID pageID;
+    uint16_t slotID;
+    parseRecordID(recordID, pageID, slotID);
+
+    auto it = moved.find(pageID);
+    return it == moved.end() ? recordID : makeRecordID(it->second, slotID);
+}
+
 uint64_t HeapFile::makeRecordID(uint32_t pageID, uint16_t slotID) const {
     return (static_cast<uint64_t>(pageID) << 16) | slotID;
 }
@@ -54,26 +85,26 @@ void HeapFile::parseRecordID(uint64_t recordID, uint32_t& pageID, uint16_t& slot
 
 uint64_t HeapFile::insert(const std::string& record) {
     for (PageID pageID : m_Pages) {
-        Page& p = m_BufferPool.fetchPage(pageID);
-        HeapPage hp(p);
+        // Only pages that take the record end up dirty
+        WritePageGuard guard = m_BufferPool.fetchPageWrite(pageID);
+        if (!HeapPage(std::as_const(guard).page()).canInsert(record.size()))
+            continue;
+
+        HeapPage hp(guard.page());
         int slotID = hp.insert(record);
         if (slotID >= 0) {
-            m_BufferPool.markDirty(pageID);
-            m_BufferPool.unpinPage(pageID);
             return makeRecordID(pageID, slotID);
         }
-        m_BufferPool.unpinPage(pageID);
     }
 
-    PageID newPageID = m_BufferPool.allocatePage();
-    Page& newPage = m_BufferPool.fetchPage(newPageID);
+    // Keep the heap chain physically close to its tail
+    WritePageGuard guard = m_BufferPool.newPage(m_Pages.empty() ? 0 : m_Pages.back());
+    PageID newPageID = guard.pageID();
+    Page& newPage = guard.page();
 
     if (!m_Pages.empty()) {
-        PageID lastPageID = m_Pages.back();
-        Page& lastPage = m_BufferPool.fetchPage(lastPageID);
-        lastPage.header()->m_NextPageID = newPageID;
-        m_BufferPool.markDirty(lastPageID);
-        m_BufferPool.unpinPage(lastPageID);
+        WritePageGuard last = m_BufferPool.fetchPageWrite(m_Pages.back());
+        last.page().header()->m_NextPageID = newPageID;
     }
 
     newPage.header()->m_Type = PageType::HEAP;
@@ -83,9 +114,6 @@ uint64_t HeapFile::insert(const std::string& record) {
     HeapPage hp(newPage);
     int slotID = hp.insert(record);
 
-    m_BufferPool.markDirty(newPageID);
-    m_BufferPool.unpinPage(newPageID);
-
     m_Pages.push_back(newPageID);
     return makeRecordID(newPageID, slotID);
 }
@@ -95,15 +123,9 @@ bool HeapFile::remove(uint64_t recordID) {
     uint16_t slotID;
     parseRecordID(recordID, pageID, slotID);
 
-    Page& page = m_BufferPool.fetchPage(pageID);
-    HeapPage hp(page);
-
-    bool ok = hp.remove(slotID);
-    if (ok)
-        m_BufferPool.markDirty(pageID);
-
-    m_BufferPool.unpinPage(pageID);
-    return ok;
+    WritePageGuard guard = m_BufferPool.fetchPageWrite(pageID);
+    HeapPage hp(guard.page());
+    return hp.remove(slotID);
 }
 
 std::string HeapFile::get(uint64_t recordID) const {
@@ -111,21 +133,35 @@ std::string HeapFile::get(uint64_t recordID) const {
     uint16_t slotID;
     parseRecordID(recordID, pageID, slotID);
 
-    Page& page = m_BufferPool.fetchPage(pageID);
-    HeapPage hp(page);
-    std::string data = hp.get(slotID);
-
-    m_BufferPool.unpinPage(pageID);
-    return data;
+    ReadPageGuard guard = m_BufferPool.fetchPageRead(pageID);
+    HeapPage hp(guard.page());
+    return hp.get(slotID);
 }
 
 void HeapFile::scan(std::function<void(uint64_t, const std::string&)> visitor) const {
-    for (PageID pageID : m_Pages) {
-        Page& page = m_BufferPool.fetchPage(pageID);
-        HeapPage hp(page);
+    // Hint each run of consecutive pages as sequential so the kernel reads ahead
+    size_t runStart = 0;
+    for (size_t i = 1; i <= m_Pages.size(); ++i) {
+        if (i == m_Pages.size() || m_Pages[i] != m_Pages[i - 1] + 1) {
+            m_BufferPool.adviseAccess(m_Pages[runStart], static_cast<uint32_t>(i - runStart), AccessPattern::SEQUENTIAL);
+            runStart = i;
+        }
+    }
+
+    for (size_t i = 0; i < m_Pages.size(); ++i) {
+        // Prefetch the next window while the current one is visited
+        if (i % SCAN_PREFETCH_WINDOW == 0) {
+            size_t begin = i + (i == 0 ? 0 : SCAN_PREFETCH_WINDOW);
+            size_t end = std::min(m_Pages.size(), begin + (i == 0 ? 2 : 1) * SCAN_PREFETCH_WINDOW);
+            if (begin < end)
+                m_BufferPool.prefetch(std::span<const PageID>(m_Pages.data() + begin, end - begin));
+        }
+
+        PageID pageID = m_Pages[i];
+        ReadPageGuard guard = m_BufferPool.fetchPageRead(pageID);
+        HeapPage hp(guard.page());
         hp.scan([&](uint16_t slotID, const std::string& record) {
             visitor(makeRecordID(pageID, slotID), record);
         });
-        m_BufferPool.unpinPage(pageID);
     }
 }
@@ -26,6 +26,12 @@ HeapPage::HeapPage(Page& page)
     }
 }
 
+// No repairs on a shared page: a blank or damaged page reads back without records
+HeapPage::HeapPage(const Page& page)
+    : m_Page(const_cast<Page&>(page))
+{
+}
+
 uint16_t HeapPage::numSlots() const {
     return *reinterpret_cast<const uint16_t*>(m_Page.data() + HEADER_SIZE);
 }
@@ -34,16 +40,20 @@ uint16_t& HeapPage::numSlots() {
     return *reinterpret_cast<uint16_t*>(m_Page.data() + HEADER_SIZE);
 }
 
-uint16_t HeapPage::freeSpaceOffset() const {
-    return *reinterpret_cast<const uint16_t*>(m_Page.data() + HEADER_SIZE + sizeof(uint16_t));
+size_t HeapPage::freeSpaceOffset() const {
+    SlotOffset offset;
+    std::memcpy(&offset, m_Page.data() + HEADER_SIZE + sizeof(uint16_t), sizeof(offset));
+    return offset;
 }
 
-void HeapPage::setFreeSpaceOffset(uint16_t offset) {
-    *reinterpret_cast<uint16_t*>(m_Page.data() + HEADER_SIZE + sizeof(uint16_t)) = offset;
+void HeapPage::setFreeSpaceOffset(size_t offset) {
+    // PAGE_SIZE itself (an empty page) must be representable: it is with 16 bits up to 32 KiB pages
+    SlotOffset value = static_cast<SlotOffset>(offset);
+    std::memcpy(m_Page.data() + HEADER_SIZE + sizeof(uint16_t), &value, sizeof(value));
 }
 
-uint16_t HeapPage::headerSize() const {
-    return HEADER_SIZE + sizeof(uint16_t) * 2 + numSlots() * sizeof(Slot);
+size_t HeapPage::headerSize() const {
+    return HEAP_PAGE_HEADER_SIZE + numSlots() * sizeof(Slot);
 }
 
 HeapPage::Slot HeapPage::getSlot(uint16_t slotID) const 
@@ -51,7 +61,7 @@ HeapPage::Slot HeapPage::getSlot(uint16_t slotID) const
     if(slotID >= numSlots())
         throw std::runtime_error("Invalid slotID");
 
-    const char* base = m_Page.data() + HEADER_SIZE + sizeof(uint16_t) * 2;
+    const char* base = m_Page.data() + HEAP_PAGE_HEADER_SIZE;
     const char* ptr  = base + slotID * sizeof(Slot);
     Slot slot;
     std::memcpy(&slot, ptr, sizeof(Slot));
@@ -61,16 +71,35 @@ HeapPage::Slot HeapPage::getSlot(uint16_t slotID) const
 
 void HeapPage::setSlot(uint16_t slotID, const Slot& slot)
 {
-    char* base = m_Page.data() + HEADER_SIZE + sizeof(uint16_t) * 2;
+    char* base = m_Page.data() + HEAP_PAGE_HEADER_SIZE;
     char* ptr  = base + slotID * sizeof(Slot);
     std::memcpy(ptr, &slot, sizeof(Slot));
 }
 
-int HeapPage::insert(const std::string& record) {
-    uint16_t spaceNeeded = sizeof(Slot) + record.size();
-    uint16_t freeSpaceAvailable = freeSpaceOffset() - (headerSize() + sizeof(Slot));
+bool HeapPage::canInsert(size_t recordSize) const {
+    // Judge the page as the mutable constructor would leave it
+    bool blank = m_Page.header()->m_Type == PageType::INVALID;
+    size_t freeOffset = freeSpaceOffset();
+    if (blank || freeOffset == 0 || freeOffset > PAGE_SIZE)
+        freeOffset = PAGE_SIZE;
+    uint16_t slots = blank || numSlots() > MAX_SLOTS ? 0 : numSlots();
+
+    // Room for the record plus a new slot, even when a free slot ends up reused
+    if (freeOffset < HEAP_PAGE_HEADER_SIZE + (slots + 1) * sizeof(Slot) + recordSize)
+        return false;
+
+    if (slots < MAX_SLOTS)
+        return true;
 
-    if (freeSpaceAvailable < record.size()) {
+    for (uint16_t i = 0; i < slots; ++i) {
+        if (getSlot(i).length == 0)
+            return true;
+    }
+    return false;
+}
+
+int HeapPage::insert(const std::string& record) {
+    if (!canInsert(record.size())) {
         return -1;  // Not enough space
     }
 
@@ -78,9 +107,9 @@ int HeapPage::insert(const std::string& record) {
     for (uint16_t i = 0; i < numSlots(); ++i) {
         Slot slot = getSlot(i);
         if (slot.length == 0) {
-            uint16_t offset = freeSpaceOffset() - record.size();
+            size_t offset = freeSpaceOffset() - record.size();
             if (offset < headerSize()) return -1;
-            Slot newSlot{ offset, static_cast<uint16_t>(record.size()) };
+            Slot newSlot{ static_cast<SlotOffset>(offset), static_cast<SlotOffset>(record.size()) };
             setSlot(i, newSlot);
             std::memcpy(m_Page.data() + offset, record.data(), record.size());
             setFreeSpaceOffset(offset);
@@ -88,12 +117,14 @@ int HeapPage::insert(const std::string& record) {
         }
     }
 
+    if (numSlots() >= MAX_SLOTS) return -1;
+
     // New slot
     uint16_t slotID = numSlots();
-    uint16_t offset = freeSpaceOffset() - record.size();
+    size_t offset = freeSpaceOffset() - record.size();
     if (offset < headerSize()) return -1;
 
-    Slot slot{ offset, static_cast<uint16_t>(record.size()) };
+    Slot slot{ static_cast<SlotOffset>(offset), static_cast<SlotOffset>(record.size()) };
     setSlot(slotID, slot);
     std::memcpy(m_Page.data() + offset, record.data(), record.size());
     setFreeSpaceOffset(offset);
@@ -0,0 +1,352 @@
+#include "pebble/core/IoUringFileManager.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+using namespace pebble::core;
+
+namespace {
+
+    // user_data: first page ID in the low half, then the number of pages and the batch ID
+    constexpr size_t MAX_BATCHES = 1 << 16;
+
+    uint64_t makeUserData(uint16_t batch, uint32_t pageID, uint32_t numPages) {
+        return (static_cast<uint64_t>(batch) << 48) | (static_cast<uint64_t>(numPages) << 32) | pageID;
+    }
+
+    int ioUringSetup(unsigned entries, io_uring_params* params) {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+}
+
+IoUringFileManager::IoUringFileManager(const std::string& filename, unsigned queueDepth)
+    : PosixFileManager(filename)
+{
+    setupRing(queueDepth);
+}
+
+IoUringFileManager::~IoUringFileManager()
+{
+    // Drain every batch, the buffers of requests nobody waited for must not be written after this
+    if (usingIoUring()) {
+        try {
+            std::lock_guard<std::mutex> lock(m_RingMutex);
+            submitQueued();
+            while (m_InFlight > 0)
+                reap(m_InFlight);
+        } catch (const std::exception& e) {
+            std::cerr << "IoUringFileManager: " << e.what() << "\n";
+        }
+    }
+    teardownRing();
+}
+
+void IoUringFileManager::setupRing(unsigned entries)
+{
+    io_uring_params params {};
+    int fd = ioUringSetup(entries, &params);
+    if (fd < 0) {
+        std::cerr << "io_uring unavailable (" << std::strerror(errno) << "), using synchronous I/O\n";
+        return;
+    }
+    m_RingFd = fd;
+    m_QueueDepth = params.sq_entries;
+
+    m_SqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        m_SqRingSize = m_CqRingSize = std::max(m_SqRingSize, m_CqRingSize);
+    }
+
+    m_SqRing = ::mmap(nullptr, m_SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (m_SqRing == MAP_FAILED) {
+        m_SqRing = nullptr;
+        teardownRing();
+        throw std::runtime_error("Failed to map io_uring submission queue");
+    }
+
+    if (singleMmap) {
+        m_CqRing = m_SqRing;
+    } else {
+        m_CqRing = ::mmap(nullptr, m_CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (m_CqRing == MAP_FAILED) {
+            m_CqRing = nullptr;
+            teardownRing();
+            throw std::runtime_error("Failed to map io_uring completion queue");
+        }
+    }
+
+    m_SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, m_SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        teardownRing();
+        throw std::runtime_error("Failed to map io_uring SQE array");
+    }
+    m_Sqes = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(m_SqRing);
+    m_SqHead  = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    m_SqTail  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    m_SqMask  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    m_SqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+    char* cq = static_cast<char*>(m_CqRing);
+    m_CqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    m_CqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    m_CqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    m_Cqes   = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+void IoUringFileManager::teardownRing()
+{
+    if (m_Sqes) ::munmap(m_Sqes, m_SqesSize);
+    if (m_CqRing && m_CqRing != m_SqRing) ::munmap(m_CqRing, m_CqRingSize);
+    if (m_SqRing) ::munmap(m_SqRing, m_SqRingSize);
+    if (m_RingFd >= 0) ::close(m_RingFd);
+
+    m_Sqes = nullptr;
+    m_SqRing = m_CqRing = nullptr;
+    m_RingFd = -1;
+}
+
+io_uring_sqe* IoUringFileManager::nextSqe()
+{
+    // Keep at most m_QueueDepth requests outstanding so the CQ can never overflow
+    if (m_Queued + m_InFlight >= m_QueueDepth) {
+        submitQueued();
+        reap(1);
+    }
+
+    unsigned tail = *m_SqTail;
+    unsigned idx = tail & *m_SqMask;
+    io_uring_sqe* sqe = &m_Sqes[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+
+    m_SqArray[idx] = idx;
+    __atomic_store_n(m_SqTail, tail + 1, __ATOMIC_RELEASE);
+    m_Queued++;
+    return sqe;
+}
+
+uint16_t IoUringFileManager::callerBatch()
+{
+    std::thread::id self = std::this_thread::get_id();
+    size_t slot = m_Batches.size();
+    for (size_t i = 0; i < m_Batches.size(); ++i) {
+        if (m_Batches[i].owner == self)
+            return static_cast<uint16_t>(i);
+        if (slot == m_Batches.size() && m_Batches[i].owner == std::thread::id())
+            slot = i;
+    }
+
+    if (slot == m_Batches.size()) {
+        if (slot == MAX_BATCHES)
+            throw std::runtime_error("Too many threads with async I/O in flight");
+        m_Batches.emplace_back();
+    }
+    m_Batches[slot].owner = self;
+    return static_cast<uint16_t>(slot);
+}
+
+void IoUringFileManager::readPageAsync(uint32_t pageID, Page& page)
+{
+    if (!usingIoUring()) {
+        readPage(pageID, page);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_RingMutex);
+    uint16_t batch = callerBatch();
+
+    // The ID is set once the read is verified: a never-written page reads back all zeros
+    m_Batches[batch].reads.emplace_back(&page, pageID);
+
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = m_Fd;
+    sqe->addr = reinterpret_cast<uint64_t>(page.data());
+    sqe->len = PAGE_SIZE;
+    sqe->off = static_cast<uint64_t>(pageID) * PAGE_SIZE;
+    sqe->user_data = makeUserData(batch, pageID, 1);
+    m_Batches[batch].outstanding++;
+}
+
+void IoUringFileManager::writePageAsync(const Page& page)
+{
+    if (!usingIoUring()) {
+        writePage(page);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_RingMutex);
+    uint16_t batch = callerBatch();
+    page.stampChecksum();
+
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = m_Fd;
+    sqe->addr = reinterpret_cast<uint64_t>(page.data());
+    sqe->len = PAGE_SIZE;
+    sqe->off = static_cast<uint64_t>(page.getPageID()) * PAGE_SIZE;
+    sqe->user_data = makeUserData(batch, page.getPageID(), 1);
+    m_Batches[batch].outstanding++;
+}
+
+void IoUringFileManager::writePages(std::vector<const Page*> pages)
+{
+    if (!usingIoUring()) {
+        PosixFileManager::writePages(std::move(pages));
+        return;
+    }
+
+    sortByPageID(pages);
+
+    // One iovec per page, reserved up front so SQEs can point into it until waitAll()
+    std::vector<iovec> iov;
+    iov.reserve(pages.size());
+    for (const Page* page : pages) {
+        page->stampChecksum();
+        iov.push_back({ const_cast<char*>(page->data()), PAGE_SIZE });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_RingMutex);
+        uint16_t batch = callerBatch();
+
+        size_t i = 0;
+        while (i < pages.size()) {
+            uint32_t firstID = pages[i]->getPageID();
+            size_t j = i + 1;
+            while (j < pages.size() && j - i < MAX_IOVECS && pages[j]->getPageID() == firstID + (j - i))
+                ++j;
+
+            io_uring_sqe* sqe = nextSqe();
+            sqe->opcode = IORING_OP_WRITEV;
+            sqe->fd = m_Fd;
+            sqe->addr = reinterpret_cast<uint64_t>(&iov[i]);
+            sqe->len = static_cast<uint32_t>(j - i);
+            sqe->off = static_cast<uint64_t>(firstID) * PAGE_SIZE;
+            sqe->user_data = makeUserData(batch, firstID, static_cast<uint32_t>(j - i));
+            m_Batches[batch].outstanding++;
+
+            i = j;
+        }
+    }
+
+    waitAll();
+}
+
+size_t IoUringFileManager::submit()
+{
+    if (!usingIoUring())
+        return 0;
+
+    std::lock_guard<std::mutex> lock(m_RingMutex);
+    return submitQueued();
+}
+
+size_t IoUringFileManager::submitQueued()
+{
+    size_t submitted = 0;
+    while (m_Queued > 0) {
+        int ret = ioUringEnter(m_RingFd, m_Queued, 0, 0);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EBUSY) {
+                reap(1);
+                continue;
+            }
+            throw std::runtime_error(std::string("io_uring_enter submit failed: ") + std::strerror(errno));
+        }
+        m_Queued -= ret;
+        m_InFlight += ret;
+        submitted += ret;
+    }
+    return submitted;
+}
+
+void IoUringFileManager::reap(unsigned minComplete)
+{
+    minComplete = std::min(minComplete, m_InFlight);
+    if (minComplete > 0) {
+        while (true) {
+            unsigned ready = __atomic_load_n(m_CqTail, __ATOMIC_ACQUIRE) - *m_CqHead;
+            if (ready >= minComplete)
+                break;
+            int ret = ioUringEnter(m_RingFd, 0, minComplete, IORING_ENTER_GETEVENTS);
+            if (ret < 0 && errno != EINTR) {
+                throw std::runtime_error(std::string("io_uring_enter wait failed: ") + std::strerror(errno));
+            }
+        }
+    }
+
+    unsigned head = *m_CqHead;
+    unsigned tail = __atomic_load_n(m_CqTail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const io_uring_cqe& cqe = m_Cqes[head & *m_CqMask];
+        Batch& batch = m_Batches[cqe.user_data >> 48];
+        int expected = static_cast<int>(((cqe.user_data >> 32) & 0xFFFF) * PAGE_SIZE);
+
+        if (cqe.res != expected && !batch.failed) {
+            batch.failed = true;
+            batch.failedPageID = static_cast<uint32_t>(cqe.user_data);
+        }
+        batch.outstanding--;
+
+        ++head;
+        --m_InFlight;
+    }
+    __atomic_store_n(m_CqHead, head, __ATOMIC_RELEASE);
+}
+
+void IoUringFileManager::waitAll()
+{
+    if (!usingIoUring())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_RingMutex);
+    uint16_t id = callerBatch();
+
+    // Completions of other batches reaped meanwhile are left for their own waitAll()
+    submitQueued();
+    while (m_Batches[id].outstanding > 0) {
+        reap(m_Batches[id].outstanding);
+    }
+
+    Batch batch = std::move(m_Batches[id]);
+    m_Batches[id] = Batch{};
+
+    if (batch.failed) {
+        throw std::runtime_error("Async I/O failed for page " + std::to_string(batch.failedPageID));
+    }
+
+    // Every read has landed, check them all before reporting the first mismatch
+    uint32_t badPageID = 0;
+    bool bad = false;
+    for (auto [page, pageID] : batch.reads) {
+        if (!page->verifyChecksum()) {
+            m_ChecksumFailures.fetch_add(1, std::memory_order_relaxed);
+            if (!bad) badPageID = pageID;
+            bad = true;
+        } else {
+            page->setPageID(pageID);
+        }
+    }
+    if (bad) {
+        throw std::runtime_error("Checksum mismatch on page " + std::to_string(badPageID));
+    }
+}
@@ -0,0 +1,152 @@
+#include "pebble/core/KeySearch.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PEBBLE_KEYSEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace pebble::core;
+
+namespace {
+
+    // Keys compared at once at the end of a search: a cache line or two, two AVX2 loads
+    constexpr int WINDOW = 16;
+
+    inline int loadKey(const char* keys, int i) {
+        int key;
+        std::memcpy(&key, keys + i * sizeof(int), sizeof(int));
+        return key;
+    }
+
+    // Upper: keys <= key count as below, else keys < key
+    template <bool Upper>
+    inline bool below(int k, int key) {
+        return Upper ? k <= key : k < key;
+    }
+
+    template <bool Upper>
+    int countScalar(const char* keys, int n, int key) {
+        int count = 0;
+        for (int i = 0; i < n; ++i)
+            count += below<Upper>(loadKey(keys, i), key);
+        return count;
+    }
+
+    // Index of the first key not below key, n >= WINDOW. The binary search keeps every key
+    // before base below key and every key from base + n on not, the comparison only picking an
+    // offset (a cmov). Once n <= WINDOW, a window of exactly WINDOW keys that covers
+    // [base, base + n) is counted whole, with no loop or tail to branch on.
+    template <bool Upper, typename CountWindow>
+    inline int search(const char* keys, int n, int key, CountWindow countWindow) {
+        const char* last = keys + (n - WINDOW) * sizeof(int);
+        const char* base = keys;
+        while (n > WINDOW) {
+            int half = n / 2;
+            base += below<Upper>(loadKey(base, half), key) ? half * sizeof(int) : 0;
+            n -= half;
+        }
+        const char* window = std::min(base, last);
+        return static_cast<int>((window - keys) / sizeof(int)) + countWindow(window, key);
+    }
+
+    template <bool Upper>
+    int countWindowScalar(const char* keys, int key) {
+        return countScalar<Upper>(keys, WINDOW, key);
+    }
+
+    enum class Isa { SCALAR, SSE2, AVX2 };
+
+#if defined(PEBBLE_KEYSEARCH_X86) && defined(__SSE2__)
+    // Signed compares give k < key as key > k, and k <= key as the lanes without k > key
+    template <bool Upper>
+    int countWindowSse2(const char* keys, int key) {
+        __m128i needle = _mm_set1_epi32(key);
+        int count = 0;
+        for (int i = 0; i < WINDOW; i += 4) {
+            __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i * sizeof(int)));
+            __m128i gt = Upper ? _mm_cmpgt_epi32(k, needle) : _mm_cmpgt_epi32(needle, k);
+            count += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(gt))));
+        }
+        return Upper ? WINDOW - count : count;
+    }
+
+    template <bool Upper>
+    __attribute__((target("avx2")))
+    int countWindowAvx2(const char* keys, int key) {
+        __m256i needle = _mm256_set1_epi32(key);
+        int count = 0;
+        for (int i = 0; i < WINDOW; i += 8) {
+            __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i * sizeof(int)));
+            __m256i gt = Upper ? _mm256_cmpgt_epi32(k, needle) : _mm256_cmpgt_epi32(needle, k);
+            count += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(gt))));
+        }
+        return Upper ? WINDOW - count : count;
+    }
+
+    Isa detectIsa() {
+        return __builtin_cpu_supports("avx2") ? Isa::AVX2 : Isa::SSE2;
+    }
+#else
+    Isa detectIsa() {
+        return Isa::SCALAR;
+    }
+#endif
+
+    const Isa ISA = detectIsa();
+
+    template <bool Upper>
+    int searchBest(const void* keys, int n, int key) {
+        const char* p = static_cast<const char*>(keys);
+        if (n < WINDOW)
+            return countScalar<Upper>(p, n, key);       // a small node: one short pass
+#if defined(PEBBLE_KEYSEARCH_X86) && defined(__SSE2__)
+        if (ISA == Isa::AVX2)
+            return search<Upper>(p, n, key, countWindowAvx2<Upper>);
+        return search<Upper>(p, n, key, countWindowSse2<Upper>);
+#else
+        return search<Upper>(p, n, key, countWindowScalar<Upper>);
+#endif
+    }
+
+    template <bool Upper>
+    int searchPortable(const void* keys, int n, int key) {
+        const char* p = static_cast<const char*>(keys);
+        if (n < WINDOW)
+            return countScalar<Upper>(p, n, key);
+        return search<Upper>(p, n, key, countWindowScalar<Upper>);
+    }
+
+}
+
+int pebble::core::keyLowerBound(const void* keys, int n, int key)
+{
+    return searchBest<false>(keys, n, key);
+}
+
+int pebble::core::keyUpperBound(const void* keys, int n, int key)
+{
+    return searchBest<true>(keys, n, key);
+}
+
+int pebble::core::keyLowerBoundPortable(const void* keys, int n, int key)
+{
+    return searchPortable<false>(keys, n, key);
+}
+
+int pebble::core::keyUpperBoundPortable(const void* keys, int n, int key)
+{
+    return searchPortable<true>(keys, n, key);
+}
+
+const char* pebble::core::keySearchInstructionSet()
+{
+    switch (ISA) {
+        case Isa::AVX2: return "avx2";
+        case Isa::SSE2: return "sse2";
+        default:        return "scalar";
+    }
+}
@@ -0,0 +1,105 @@
+#include "pebble/core/LruKPolicy.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace pebble::core;
+
+LruKPolicy::LruKPolicy(size_t capacity, unsigned k)
+    : m_K(k), m_RetainedMax(capacity)
+{
+    if (k == 0) {
+        throw std::invalid_argument("LRU-K needs K >= 1");
+    }
+
+    m_Times.assign(capacity * k, 0);
+    m_PageIDs.assign(capacity, 0);
+    m_Resident.assign(capacity, false);
+}
+
+LruKPolicy::Key LruKPolicy::key(uint32_t frame) const
+{
+    const uint64_t* t = times(frame);
+    return t[m_K - 1] != 0 ? Key{ true, t[m_K - 1], frame } : Key{ false, t[0], frame };
+}
+
+void LruKPolicy::reference(uint32_t frame)
+{
+    uint64_t* t = times(frame);
+    std::copy_backward(t, t + m_K - 1, t + m_K);
+    t[0] = ++m_Clock;
+}
+
+void LruKPolicy::recordHit(uint32_t frame)
+{
+    if (!m_Resident[frame])
+        return;
+
+    m_Order.erase(key(frame));
+    reference(frame);
+    m_Order.insert(key(frame));
+}
+
+void LruKPolicy::recordLoad(uint32_t frame, uint32_t pageID)
+{
+    if (m_Resident[frame])
+        m_Order.erase(key(frame));
+
+    // A page evicted recently comes back with its earlier references
+    uint64_t* t = times(frame);
+    auto it = m_Retained.find(pageID);
+    if (it != m_Retained.end()) {
+        std::copy(it->second.times.begin(), it->second.times.end(), t);
+        m_Retained.erase(it);
+    }
+    else {
+        std::fill(t, t + m_K, 0);
+    }
+
+    m_PageIDs[frame] = pageID;
+    m_Resident[frame] = true;
+    reference(frame);
+    m_Order.insert(key(frame));
+}
+
+void LruKPolicy::recordEvict(uint32_t frame)
+{
+    if (!m_Resident[frame])
+        return;
+
+    m_Order.erase(key(frame));
+    m_Resident[frame] = false;
+
+    uint32_t pageID = m_PageIDs[frame];
+    Retained& retained = m_Retained[pageID];
+    retained.times.assign(times(frame), times(frame) + m_K);
+    retained.evictedAt = ++m_Clock;
+    m_RetainedOrder.emplace_back(pageID, retained.evictedAt);
+
+    // Drop the oldest retained histories, unless the page came back (or was evicted again) since
+    while (m_RetainedOrder.size() > m_RetainedMax) {
+        auto [oldID, evictedAt] = m_RetainedOrder.front();
+        m_RetainedOrder.pop_front();
+
+        auto old = m_Retained.find(oldID);
+        if (old != m_Retained.end() && old->second.evictedAt == evictedAt)
+            m_Retained.erase(old);
+    }
+}
+
+void LruKPolicy::forget(uint32_t frame)
+{
+    if (!m_Resident[frame])
+        return;
+
+    m_Order.erase(key(frame));
+    m_Resident[frame] = false;
+}
+
+void LruKPolicy::forEachVictim(const std::function<bool(uint32_t frame)>& fn) const
+{
+    for (const Key& k : m_Order) {
+        if (!fn(std::get<2>(k)))
+            return;
+    }
+}
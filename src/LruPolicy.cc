@@ -0,0 +1,36 @@
+#include "pebble/core/LruPolicy.h"
+
+using namespace pebble::core;
+
+LruPolicy::LruPolicy(size_t capacity)
+    : m_Links(capacity), m_Resident(capacity, false)
+{}
+
+void LruPolicy::recordHit(uint32_t frame)
+{
+    if (m_Resident[frame])
+        m_Links.moveToFront(m_List, frame);
+}
+
+void LruPolicy::recordLoad(uint32_t frame, uint32_t)
+{
+    if (m_Resident[frame])
+        m_Links.remove(m_List, frame);
+
+    m_Links.pushFront(m_List, frame);
+    m_Resident[frame] = true;
+}
+
+void LruPolicy::forget(uint32_t frame)
+{
+    if (!m_Resident[frame])
+        return;
+
+    m_Links.remove(m_List, frame);
+    m_Resident[frame] = false;
+}
+
+void LruPolicy::forEachVictim(const std::function<bool(uint32_t frame)>& fn) const
+{
+    m_Links.forEachFromTail(m_List, fn);
+}
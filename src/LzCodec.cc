@@ -0,0 +1,168 @@
+#include "pebble/core/LzCodec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace pebble::core;
+
+namespace {
+
+    constexpr size_t MIN_MATCH = 4;
+    constexpr size_t MAX_OFFSET = 65535;
+    constexpr unsigned HASH_BITS = 12;
+
+    uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint32_t hash(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // Bounded output cursor, every put checks the capacity
+    struct Writer {
+        uint8_t* out;
+        uint8_t* end;
+
+        bool put(uint8_t b) {
+            if (out == end) return false;
+            *out++ = b;
+            return true;
+        }
+
+        bool put(const uint8_t* p, size_t n) {
+            if (static_cast<size_t>(end - out) < n) return false;
+            if (n == 0) return true;
+            std::memcpy(out, p, n);
+            out += n;
+            return true;
+        }
+
+        // 255-run encoding of a length that overflowed its 4-bit token field
+        bool putLength(size_t n) {
+            for (; n >= 255; n -= 255)
+                if (!put(255)) return false;
+            return put(static_cast<uint8_t>(n));
+        }
+    };
+
+    bool emitSequence(Writer& w, const uint8_t* literals, size_t numLiterals, size_t offset, size_t matchLength) {
+        size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+        uint8_t token = static_cast<uint8_t>((std::min<size_t>(numLiterals, 15) << 4) | std::min<size_t>(matchCode, 15));
+
+        if (!w.put(token)) return false;
+        if (numLiterals >= 15 && !w.putLength(numLiterals - 15)) return false;
+        if (!w.put(literals, numLiterals)) return false;
+
+        if (matchLength == 0)
+            return true;                                    // last sequence: literals only
+
+        if (!w.put(static_cast<uint8_t>(offset)) || !w.put(static_cast<uint8_t>(offset >> 8))) return false;
+        return matchCode < 15 || w.putLength(matchCode - 15);
+    }
+
+    // Read a 255-run length extension, false on truncated input
+    bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+        uint8_t b;
+        do {
+            if (ip == end) return false;
+            b = *ip++;
+            length += b;
+        } while (b == 255);
+        return true;
+    }
+
+}
+
+size_t pebble::core::lzCompress(const char* src, size_t srcSize, char* dst, size_t dstCapacity)
+{
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+    Writer w{ reinterpret_cast<uint8_t*>(dst), reinterpret_cast<uint8_t*>(dst) + dstCapacity };
+
+    // Last position in hash table + 1, 0 = empty
+    uint32_t table[1u << HASH_BITS] = {};
+
+    size_t anchor = 0;
+    size_t ip = 0;
+    size_t misses = 0;
+
+    while (srcSize >= MIN_MATCH && ip <= srcSize - MIN_MATCH) {
+        uint32_t sequence = read32(in + ip);
+        uint32_t h = hash(sequence);
+        size_t candidate = table[h];
+        table[h] = static_cast<uint32_t>(ip + 1);
+
+        if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET || read32(in + candidate - 1) != sequence) {
+            // Step faster through data that does not compress
+            ip += 1 + (misses++ >> 5);
+            continue;
+        }
+        misses = 0;
+
+        size_t ref = candidate - 1;
+        size_t length = MIN_MATCH;
+        while (ip + length < srcSize && in[ref + length] == in[ip + length])
+            ++length;
+
+        if (!emitSequence(w, in + anchor, ip - anchor, ip - ref, length))
+            return 0;
+
+        ip += length;
+        anchor = ip;
+    }
+
+    if (!emitSequence(w, in + anchor, srcSize - anchor, 0, 0))
+        return 0;
+
+    return w.out - reinterpret_cast<uint8_t*>(dst);
+}
+
+size_t pebble::core::lzDecompress(const char* src, size_t srcSize, char* dst, size_t dstCapacity)
+{
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(src);
+    const uint8_t* end = ip + srcSize;
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+    uint8_t* outBegin = out;
+    uint8_t* outEnd = out + dstCapacity;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t numLiterals = token >> 4;
+        if (numLiterals == 15 && !readLength(ip, end, numLiterals))
+            return 0;
+        if (static_cast<size_t>(end - ip) < numLiterals || static_cast<size_t>(outEnd - out) < numLiterals)
+            return 0;
+        if (numLiterals > 0)
+            std::memcpy(out, ip, numLiterals);
+        ip += numLiterals;
+        out += numLiterals;
+
+        if (ip == end)
+            break;                                          // last sequence carries no match
+
+        if (end - ip < 2)
+            return 0;
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+
+        size_t length = token & 0x0F;
+        if (length == 15 && !readLength(ip, end, length))
+            return 0;
+        length += MIN_MATCH;
+
+        if (offset == 0 || offset > static_cast<size_t>(out - outBegin) || static_cast<size_t>(outEnd - out) < length)
+            return 0;
+
+        // Byte by byte: the match may overlap the bytes it produces
+        const uint8_t* ref = out - offset;
+        for (size_t i = 0; i < length; ++i)
+            out[i] = ref[i];
+        out += length;
+    }
+
+    return out - outBegin;
+}
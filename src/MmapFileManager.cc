@@ -0,0 +1,158 @@
+#include "pebble/core/MmapFileManager.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+using namespace pebble::core;
+
+MmapFileManager::MmapFileManager(const std::string& filename, size_t maxMappedBytes)
+    : PosixFileManager(filename)
+{
+    m_OsPageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    m_Reserved = (maxMappedBytes / m_OsPageSize) * m_OsPageSize;
+
+    // Reserve address space only; file pages are mapped over it as the file grows
+    void* base = ::mmap(nullptr, m_Reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error(std::string("Failed to reserve address space for mapping: ") + std::strerror(errno));
+    }
+    m_Base = static_cast<char*>(base);
+
+    growMapping(0);
+}
+
+MmapFileManager::~MmapFileManager()
+{
+    if (m_Base) {
+        ::munmap(m_Base, m_Reserved);
+    }
+}
+
+bool MmapFileManager::isMapped(uint32_t pageID) const
+{
+    size_t end = (static_cast<size_t>(pageID) + 1) * PAGE_SIZE;
+    return end <= m_MappedBytes.load(std::memory_order_acquire);
+}
+
+bool MmapFileManager::growMapping(uint32_t pageID)
+{
+    std::lock_guard<std::mutex> lock(m_GrowMutex);
+
+    if (isMapped(pageID))
+        return true;
+
+    struct stat st;
+    if (::fstat(m_Fd, &st) != 0) {
+        throw std::runtime_error("Failed to get file size");
+    }
+
+    // Never map past EOF (touching it raises SIGBUS) or past the reservation
+    size_t mapped = m_MappedBytes.load(std::memory_order_relaxed);
+    size_t target = (static_cast<size_t>(st.st_size) / m_OsPageSize) * m_OsPageSize;
+    target = std::min(target, m_Reserved);
+
+    if (target > mapped) {
+        void* p = ::mmap(m_Base + mapped, target - mapped, PROT_READ, MAP_SHARED | MAP_FIXED,
+                         m_Fd, static_cast<off_t>(mapped));
+        if (p == MAP_FAILED) {
+            throw std::runtime_error(std::string("Failed to extend file mapping: ") + std::strerror(errno));
+        }
+        m_MappedBytes.store(target, std::memory_order_release);
+    }
+
+    return isMapped(pageID);
+}
+
+void MmapFileManager::readPage(uint32_t pageID, Page& page)
+{
+    if (!isMapped(pageID) && !growMapping(pageID)) {
+        PosixFileManager::readPage(pageID, page);
+        return;
+    }
+
+    std::memcpy(page.data(), m_Base + static_cast<size_t>(pageID) * PAGE_SIZE, PAGE_SIZE);
+    verifyChecksum(pageID, page);
+    page.setPageID(pageID);
+}
+
+uint32_t MmapFileManager::allocatePages(uint32_t count, uint32_t nearPageID)
+{
+    uint32_t first = PosixFileManager::allocatePages(count, nearPageID);
+
+    // The pages are backed by the file now, extend the mapping while we are off the read path
+    growMapping(first + count - 1);
+    return first;
+}
+
+uint32_t MmapFileManager::allocatePagesUnwritten(uint32_t count, uint32_t nearPageID)
+{
+    uint32_t first = PosixFileManager::allocatePagesUnwritten(count, nearPageID);
+    growMapping(first + count - 1);
+    return first;
+}
+
+uint32_t MmapFileManager::shrink()
+{
+    uint32_t cut = PosixFileManager::shrink();
+
+    std::lock_guard<std::mutex> lock(m_GrowMutex);
+
+    struct stat st;
+    if (::fstat(m_Fd, &st) != 0) {
+        throw std::runtime_error("Failed to get file size");
+    }
+
+    // Touching the mapping past EOF raises SIGBUS, put the reservation back over that range
+    size_t mapped = m_MappedBytes.load(std::memory_order_relaxed);
+    size_t target = (static_cast<size_t>(st.st_size) / m_OsPageSize) * m_OsPageSize;
+
+    if (target < mapped) {
+        m_MappedBytes.store(target, std::memory_order_release);
+        void* p = ::mmap(m_Base + target, mapped - target, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error(std::string("Failed to release file mapping: ") + std::strerror(errno));
+        }
+    }
+
+    return cut;
+}
+
+void MmapFileManager::adviseAccess(uint32_t pageID, uint32_t numPages, AccessPattern pattern)
+{
+    PosixFileManager::adviseAccess(pageID, numPages, pattern);
+
+    size_t begin = static_cast<size_t>(pageID) * PAGE_SIZE;
+    size_t end = std::min(begin + static_cast<size_t>(numPages) * PAGE_SIZE, mappedBytes());
+
+    // madvise needs an OS-page aligned start
+    begin = (begin / m_OsPageSize) * m_OsPageSize;
+    if (begin >= end)
+        return;
+
+    int advice = MADV_NORMAL;
+    switch (pattern) {
+        case AccessPattern::SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+        case AccessPattern::RANDOM:     advice = MADV_RANDOM; break;
+        default: break;
+    }
+
+    // Only a hint, failures are ignored
+    ::madvise(m_Base + begin, end - begin, advice);
+}
+
+void MmapFileManager::prefetch(std::span<const uint32_t> pageIDs)
+{
+    // Fault the mapped runs in ahead of the memcpy in readPage
+    size_t mapped = mappedBytes();
+    forEachRun(pageIDs, [&](uint32_t first, uint32_t count) {
+        size_t begin = (static_cast<size_t>(first) * PAGE_SIZE / m_OsPageSize) * m_OsPageSize;
+        size_t end = std::min((static_cast<size_t>(first) + count) * PAGE_SIZE, mapped);
+        if (begin < end)
+            ::madvise(m_Base + begin, end - begin, MADV_WILLNEED);
+    });
+}
@@ -1,11 +1,51 @@
 #include "pebble/core/Page.h"
+#include "pebble/core/Crc32c.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
 
 using namespace pebble::core;
 
-Page::Page() {
+namespace {
+
+    char* allocateBuffer() {
+        return static_cast<char*>(::operator new(PAGE_SIZE, std::align_val_t(PAGE_ALIGNMENT)));
+    }
+
+}
+
+void Page::AlignedDelete::operator()(char* p) const {
+    if (owned)
+        ::operator delete(p, std::align_val_t(PAGE_ALIGNMENT));
+}
+
+Page::Page()
+    : m_Buffer(allocateBuffer(), AlignedDelete{ true })
+{
     clear();
 }
 
+Page::Page(char* buffer)
+    : m_Buffer(buffer, AlignedDelete{ false })
+{
+}
+
+Page::Page(const Page& other)
+    : m_Buffer(allocateBuffer(), AlignedDelete{ true })
+{
+    std::memcpy(m_Buffer.get(), other.m_Buffer.get(), PAGE_SIZE);
+}
+
+Page& Page::operator=(const Page& other) {
+    if (this != &other) {
+        if (!m_Buffer)
+            m_Buffer = { allocateBuffer(), AlignedDelete{ true } };
+        std::memcpy(m_Buffer.get(), other.m_Buffer.get(), PAGE_SIZE);
+    }
+    return *this;
+}
+
 void Page::setPageID(PageID id) {
     header()->m_PageID = id;
 }
@@ -15,34 +55,57 @@ PageID Page::getPageID() const {
 }
 
 PageHeader* Page::header() {
-    return reinterpret_cast<PageHeader*>(m_Buffer.data());
+    return reinterpret_cast<PageHeader*>(m_Buffer.get());
 }
 
 const PageHeader* Page::header() const {
-    return reinterpret_cast<const PageHeader*>(m_Buffer.data());
+    return reinterpret_cast<const PageHeader*>(m_Buffer.get());
 }
 
 char* Page::payload() {
-    return m_Buffer.data() + HEADER_SIZE;
+    return m_Buffer.get() + HEADER_SIZE;
 }
 
 const char* Page::payload() const {
-    return m_Buffer.data() + HEADER_SIZE;
+    return m_Buffer.get() + HEADER_SIZE;
 }
 
 char* Page::data() {
-    return m_Buffer.data();
+    return m_Buffer.get();
 }
 
 const char* Page::data() const {
-    return m_Buffer.data();
+    return m_Buffer.get();
 }
 
 
 void Page::clear() {
-    std::memset(m_Buffer.data(), 0, m_Buffer.size());
+    std::memset(m_Buffer.get(), 0, PAGE_SIZE);
     header()->m_Type = PageType::INVALID;
     header()->m_PageID = 0;
     header()->m_NextPageID = 0;
 }
 
+uint32_t Page::computeChecksum() const {
+    constexpr size_t before = offsetof(PageHeader, m_Checksum);
+    constexpr size_t after = before + sizeof(PageHeader::m_Checksum);
+
+    uint32_t crc = crc32c(m_Buffer.get(), before);
+    return crc32c(m_Buffer.get() + after, PAGE_SIZE - after, crc);
+}
+
+void Page::stampChecksum() const {
+    uint32_t crc = computeChecksum();
+    std::memcpy(m_Buffer.get() + offsetof(PageHeader, m_Checksum), &crc, sizeof(crc));
+}
+
+bool Page::verifyChecksum() const {
+    uint32_t stored = header()->m_Checksum;
+    if (computeChecksum() == stored)
+        return true;
+
+    // Extents are preallocated zero-filled: a page that was allocated but never written
+    // reads back as zeros and carries no checksum.
+    return stored == 0 && std::all_of(m_Buffer.get(), m_Buffer.get() + PAGE_SIZE, [](char c) { return c == 0; });
+}
+
@@ -0,0 +1,146 @@
+#include "pebble/core/PageArena.h"
+#include "pebble/core/Page.h"
+
+#include <cstdint>
+#include <fstream>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace pebble::core;
+
+namespace {
+
+#ifdef __linux__
+    constexpr size_t DEFAULT_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    // Size of the huge pages MAP_HUGETLB hands out ("Hugepagesize:   2048 kB")
+    size_t hugetlbPageSize() {
+        std::ifstream in("/proc/meminfo");
+        std::string key;
+        size_t kb;
+        while (in >> key >> kb) {
+            if (key == "Hugepagesize:")
+                return kb * 1024;
+            in.ignore(256, '\n');
+        }
+        return DEFAULT_HUGE_PAGE_SIZE;
+    }
+
+    // Size of a transparent huge page; madvise alone does nothing where THP is "[never]"
+    size_t transparentHugePageSize() {
+        std::ifstream enabled("/sys/kernel/mm/transparent_hugepage/enabled");
+        std::string setting;
+        std::getline(enabled, setting);
+        if (setting.empty() || setting.find("[never]") != std::string::npos)
+            return 0;
+
+        std::ifstream in("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+        size_t size = 0;
+        return in >> size ? size : DEFAULT_HUGE_PAGE_SIZE;
+    }
+
+    size_t roundUp(size_t bytes, size_t unit) {
+        return (bytes + unit - 1) / unit * unit;
+    }
+#endif
+
+}
+
+std::optional<HugePageMode> pebble::core::parseHugePageMode(const std::string& name)
+{
+    if (name == "none")        return HugePageMode::NONE;
+    if (name == "transparent") return HugePageMode::TRANSPARENT;
+    if (name == "hugetlb")     return HugePageMode::HUGETLB;
+    return std::nullopt;
+}
+
+const char* pebble::core::hugePageModeName(HugePageMode mode)
+{
+    switch (mode) {
+        case HugePageMode::TRANSPARENT: return "transparent";
+        case HugePageMode::HUGETLB:     return "hugetlb";
+        default:                        return "none";
+    }
+}
+
+PageArena::PageArena(size_t pages, HugePageMode mode)
+{
+    size_t bytes = pages * PAGE_SIZE;
+
+#ifdef __linux__
+    if (mode == HugePageMode::HUGETLB) {
+        // Fails unless enough huge pages are reserved
+        size_t length = roundUp(bytes, hugetlbPageSize());
+        void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            m_Data = static_cast<char*>(p);
+            m_MappedBytes = length;
+            m_Mode = HugePageMode::HUGETLB;
+            return;
+        }
+        mode = HugePageMode::TRANSPARENT;
+    }
+
+    if (mode == HugePageMode::TRANSPARENT) {
+        if (size_t huge = transparentHugePageSize()) {
+            // Only whole, aligned huge pages inside the range can be collapsed: over-map by one,
+            // then trim to an aligned start
+            size_t length = roundUp(bytes, huge);
+            void* p = ::mmap(nullptr, length + huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED) {
+                char* raw = static_cast<char*>(p);
+                char* start = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(raw), huge));
+                if (start > raw)
+                    ::munmap(raw, start - raw);
+                if (size_t tail = (raw + length + huge) - (start + length))
+                    ::munmap(start + length, tail);
+
+                m_Data = start;
+                m_MappedBytes = length;
+                m_Mode = ::madvise(start, length, MADV_HUGEPAGE) == 0 ? HugePageMode::TRANSPARENT : HugePageMode::NONE;
+                return;
+            }
+        }
+    }
+#endif
+
+    m_Data = static_cast<char*>(::operator new(bytes, std::align_val_t(PAGE_ALIGNMENT)));
+}
+
+PageArena::~PageArena()
+{
+#ifdef __linux__
+    if (m_MappedBytes) {
+        ::munmap(m_Data, m_MappedBytes);
+        return;
+    }
+#endif
+    ::operator delete(m_Data, std::align_val_t(PAGE_ALIGNMENT));
+}
+
+char* PageArena::page(size_t i) const
+{
+    return m_Data + i * PAGE_SIZE;
+}
+
+void PageArena::release(size_t first, size_t count)
+{
+#ifdef __linux__
+    if (m_Mode == HugePageMode::HUGETLB)
+        return;
+
+    // Round inwards: a system page larger than PAGE_SIZE may hold pages still in use
+    static const size_t systemPage = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    uintptr_t start = roundUp(reinterpret_cast<uintptr_t>(page(first)), systemPage);
+    uintptr_t end = reinterpret_cast<uintptr_t>(page(first + count)) / systemPage * systemPage;
+    if (start < end)
+        ::madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTNEED);
+#else
+    (void)first;
+    (void)count;
+#endif
+}
@@ -0,0 +1,90 @@
+#include "pebble/core/PageGuard.h"
+#include "pebble/core/BufferPool.h"
+
+#include <utility>
+
+using namespace pebble::core;
+
+// Unpinning last: once the pin is gone the frame may be evicted, so the dirty flag and the
+// latch must be settled before.
+
+ReadPageGuard::ReadPageGuard(Frame& frame)
+    : m_Frame(&frame), m_Page(&frame.page)
+{
+    frame.latch.lock_shared();
+}
+
+ReadPageGuard::~ReadPageGuard()
+{
+    release();
+}
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard&& other) noexcept
+    : m_Frame(std::exchange(other.m_Frame, nullptr)),
+      m_Page(std::exchange(other.m_Page, nullptr))
+{
+}
+
+ReadPageGuard& ReadPageGuard::operator=(ReadPageGuard&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_Frame = std::exchange(other.m_Frame, nullptr);
+        m_Page = std::exchange(other.m_Page, nullptr);
+    }
+    return *this;
+}
+
+void ReadPageGuard::release()
+{
+    if (!m_Frame)
+        return;
+
+    m_Frame->latch.unlock_shared();
+    m_Frame->pinCount.fetch_sub(1, std::memory_order_release);
+    m_Frame = nullptr;
+    m_Page = nullptr;
+}
+
+WritePageGuard::WritePageGuard(Frame& frame)
+    : m_Frame(&frame), m_Page(&frame.page)
+{
+    frame.latch.lock();
+}
+
+WritePageGuard::~WritePageGuard()
+{
+    release();
+}
+
+WritePageGuard::WritePageGuard(WritePageGuard&& other) noexcept
+    : m_Frame(std::exchange(other.m_Frame, nullptr)),
+      m_Page(std::exchange(other.m_Page, nullptr)),
+      m_Dirty(std::exchange(other.m_Dirty, false))
+{
+}
+
+WritePageGuard& WritePageGuard::operator=(WritePageGuard&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_Frame = std::exchange(other.m_Frame, nullptr);
+        m_Page = std::exchange(other.m_Page, nullptr);
+        m_Dirty = std::exchange(other.m_Dirty, false);
+    }
+    return *this;
+}
+
+void WritePageGuard::release()
+{
+    if (!m_Frame)
+        return;
+
+    if (m_Dirty)
+        m_Frame->dirty.store(true, std::memory_order_release);
+    m_Frame->latch.unlock();
+    m_Frame->pinCount.fetch_sub(1, std::memory_order_release);
+    m_Frame = nullptr;
+    m_Page = nullptr;
+    m_Dirty = false;
+}
@@ -0,0 +1,68 @@
+#include "pebble/core/PageTable.h"
+
+#include <stdexcept>
+
+using namespace pebble::core;
+
+PageTable::PageTable(size_t frames)
+{
+    size_t capacity = 8;
+    unsigned bits = 3;
+    while (capacity < 2 * frames) {
+        capacity <<= 1;
+        ++bits;
+    }
+
+    m_Slots.assign(capacity, EMPTY);
+    m_Mask = capacity - 1;
+    m_Shift = 64 - bits;
+}
+
+uint32_t PageTable::find(uint32_t pageID) const
+{
+    for (size_t i = home(pageID); ; i = (i + 1) & m_Mask) {
+        uint64_t slot = m_Slots[i];
+        if (slot == EMPTY)
+            return NO_FRAME;
+        if (pageOf(slot) == pageID)
+            return frameOf(slot);
+    }
+}
+
+void PageTable::insert(uint32_t pageID, uint32_t frame)
+{
+    if (2 * (m_Size + 1) > m_Slots.size()) {
+        throw std::runtime_error("Page table full");
+    }
+
+    size_t i = home(pageID);
+    while (m_Slots[i] != EMPTY)
+        i = (i + 1) & m_Mask;
+
+    m_Slots[i] = (static_cast<uint64_t>(pageID) << 32) | frame;
+    ++m_Size;
+}
+
+void PageTable::erase(uint32_t pageID)
+{
+    size_t hole = home(pageID);
+    for (; ; hole = (hole + 1) & m_Mask) {
+        if (m_Slots[hole] == EMPTY)
+            return;
+        if (pageOf(m_Slots[hole]) == pageID)
+            break;
+    }
+    --m_Size;
+
+    // Pull later entries of the probe run back into the hole, unless that would move one in
+    // front of its home slot
+    for (size_t i = (hole + 1) & m_Mask; m_Slots[i] != EMPTY; i = (i + 1) & m_Mask) {
+        size_t h = home(pageOf(m_Slots[i]));
+        bool stays = hole < i ? (hole < h && h <= i) : (hole < h || h <= i);
+        if (!stays) {
+            m_Slots[hole] = m_Slots[i];
+            hole = i;
+        }
+    }
+    m_Slots[hole] = EMPTY;
+}
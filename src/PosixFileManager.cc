@@ -0,0 +1,456 @@
+#include "pebble/core/PosixFileManager.h"
+#include "pebble/core/MetaData.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <sys/uio.h>
+#include <vector>
+#include <algorithm>
+
+using namespace pebble::core;
+
+PosixFileManager::PosixFileManager(const std::string& filename)
+    : PosixFileManager(filename, false)
+{}
+
+PosixFileManager::PosixFileManager(const std::string& filename, bool pageCompression)
+    : m_Filename(filename)
+{
+    m_Fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_Fd < 0) {
+        throw std::runtime_error("Failed to open file: " + filename + " (" + std::strerror(errno) + ")");
+    }
+
+    try {
+        loadMetaPage();
+
+        if (m_CompressionMapPageID != 0 && !pageCompression) {
+            throw std::runtime_error("File " + filename + " stores compressed pages, open it with the compressed file manager");
+        }
+    } catch (...) {
+        ::close(m_Fd);
+        throw;
+    }
+}
+
+PosixFileManager::~PosixFileManager()
+{
+    if (m_Fd >= 0) {
+        bool persisted = false;
+        try {
+            updateMetaPage();
+            persisted = true;
+        } catch (const std::exception& e) {
+            std::cerr << "PosixFileManager: " << e.what() << "\n";
+        }
+        if (::fsync(m_Fd) == 0 && persisted)
+            punchPendingHoles();
+        ::close(m_Fd);
+    }
+}
+
+void PosixFileManager::loadMetaPage()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    MetaData meta {};
+    ssize_t bytesRead = ::pread(m_Fd, &meta, sizeof(MetaData), 0);
+
+    if (bytesRead != static_cast<ssize_t>(sizeof(MetaData)))
+    {
+        // File is empty, initialize meta page
+        m_NextPageID = 2;
+        updateMetaPage();
+    }
+    else
+    {
+        meta.checkCompatible(m_Filename);
+        m_NextPageID = meta.m_NextPageID;
+        m_CompressionMapPageID = meta.m_CompressionMapPageID;
+    }
+
+    struct stat st;
+    if (::fstat(m_Fd, &st) == 0) {
+        m_ExtentEnd = static_cast<uint32_t>(st.st_size / PAGE_SIZE);
+    }
+
+    if (bytesRead == static_cast<ssize_t>(sizeof(MetaData))) {
+        loadFreeSpaceMap(meta.m_FreeMapPageID);
+    }
+}
+
+void PosixFileManager::loadFreeSpaceMap(uint32_t mapHeadPageID)
+{
+    std::vector<Page> mapPages;
+    for (uint32_t current = mapHeadPageID; current != 0; ) {
+        Page page;
+        PosixFileManager::readPage(current, page);
+        current = page.header()->m_NextPageID;
+        mapPages.push_back(std::move(page));
+    }
+    m_FreeSpaceMap.load(std::move(mapPages));
+}
+
+// Dirty map pages (free space, and the subclass's) are written first so the meta page never points at a stale map
+void PosixFileManager::updateMetaPage()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    std::vector<const Page*> mapPages = m_FreeSpaceMap.takeDirtyPages();
+    collectDirtyMetadataPages(mapPages);
+    if (!mapPages.empty()) {
+        if (int err = writePageRuns(m_Fd, mapPages)) {
+            throw std::runtime_error(std::string("Failed to write allocation maps: ") + std::strerror(err));
+        }
+    }
+
+    MetaData meta { m_NextPageID, 0, m_FreeSpaceMap.headPageID(), m_CompressionMapPageID };
+    ssize_t written = ::pwrite(m_Fd, &meta, sizeof(MetaData), 0);
+    if (written != static_cast<ssize_t>(sizeof(MetaData))) {
+        throw std::runtime_error("Failed to write MetaData page");
+    }
+}
+
+// pread/pwrite carry their own offset, so page I/O never touches a shared
+// seek pointer and does not need m_RecMutex.
+void PosixFileManager::readPage(uint32_t pageID, Page& page)
+{
+    off_t offset = static_cast<off_t>(pageID) * PAGE_SIZE;
+
+    size_t done = 0;
+    while (done < PAGE_SIZE) {
+        ssize_t n = ::pread(m_Fd, page.data() + done, PAGE_SIZE - done, offset + done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            throw std::runtime_error("Failed to read page " + std::to_string(pageID) +
+                                     " (read " + std::to_string(done) + " bytes)");
+        }
+        done += static_cast<size_t>(n);
+    }
+
+    verifyChecksum(pageID, page);
+    page.setPageID(pageID);
+}
+
+void PosixFileManager::writePage(const Page& page)
+{
+    off_t offset = static_cast<off_t>(page.getPageID()) * PAGE_SIZE;
+    page.stampChecksum();
+
+    size_t done = 0;
+    while (done < PAGE_SIZE) {
+        ssize_t n = ::pwrite(m_Fd, page.data() + done, PAGE_SIZE - done, offset + done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            throw std::runtime_error("Failed to write page " + std::to_string(page.getPageID()));
+        }
+        done += static_cast<size_t>(n);
+    }
+
+    // No sync here: durability is provided by flush()
+}
+
+void PosixFileManager::writePages(std::vector<const Page*> pages)
+{
+    if (int err = writePageRuns(m_Fd, pages)) {
+        throw std::runtime_error(std::string("Failed to write page batch: ") + std::strerror(err));
+    }
+}
+
+int PosixFileManager::writePageRuns(int fd, std::vector<const Page*>& pages)
+{
+    sortByPageID(pages);
+    for (const Page* page : pages)
+        page->stampChecksum();
+
+    std::vector<iovec> iov;
+    iov.reserve(std::min(pages.size(), MAX_IOVECS));
+
+    size_t i = 0;
+    while (i < pages.size()) {
+        uint32_t firstID = pages[i]->getPageID();
+
+        // Gather the run [i, j) of consecutive page IDs
+        iov.clear();
+        size_t j = i;
+        while (j < pages.size() && iov.size() < MAX_IOVECS && pages[j]->getPageID() == firstID + (j - i)) {
+            iov.push_back({ const_cast<char*>(pages[j]->data()), PAGE_SIZE });
+            ++j;
+        }
+
+        off_t offset = static_cast<off_t>(firstID) * PAGE_SIZE;
+        iovec* cur = iov.data();
+        int remaining = static_cast<int>(iov.size());
+
+        while (remaining > 0) {
+            ssize_t n = ::pwritev(fd, cur, remaining, offset);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                return n < 0 ? errno : EIO;
+            }
+
+            // Skip what was written, a short write may stop inside an iovec
+            offset += n;
+            while (remaining > 0 && static_cast<size_t>(n) >= cur->iov_len) {
+                n -= cur->iov_len;
+                ++cur;
+                --remaining;
+            }
+            if (remaining > 0) {
+                cur->iov_base = static_cast<char*>(cur->iov_base) + n;
+                cur->iov_len -= n;
+            }
+        }
+
+        i = j;
+    }
+    return 0;
+}
+
+// MetaData and the free-space map are only persisted by flush(): allocation and free
+// update the in-memory copies.
+uint32_t PosixFileManager::allocatePage()
+{
+    return allocatePages(1, 0);
+}
+
+uint32_t PosixFileManager::allocatePages(uint32_t count, uint32_t nearPageID)
+{
+    return allocate(count, nearPageID, true);
+}
+
+uint32_t PosixFileManager::allocatePagesUnwritten(uint32_t count, uint32_t nearPageID)
+{
+    return allocate(count, nearPageID, false);
+}
+
+uint32_t PosixFileManager::allocate(uint32_t count, uint32_t nearPageID, bool blankReused)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    auto reused = m_FreeSpaceMap.allocate(count, nearPageID);
+    if (!reused) {
+        return allocateFromExtent(count);
+    }
+
+    // Their blocks must survive the next flush now
+    m_PendingHoles.erase(m_PendingHoles.lower_bound(*reused), m_PendingHoles.lower_bound(*reused + count));
+    if (!blankReused)
+        return *reused;
+
+    // Reused pages still hold their old contents, blank them (no read needed)
+
+    std::vector<Page> blanks(count);
+    std::vector<const Page*> batch;
+    for (uint32_t i = 0; i < count; ++i) {
+        blanks[i].setPageID(*reused + i);
+        batch.push_back(&blanks[i]);
+    }
+    writePages(std::move(batch));
+
+    return *reused;
+}
+
+uint32_t PosixFileManager::allocateFromExtent(uint32_t count)
+{
+    // Fresh pages come out of a preallocated, zero-filled extent: no I/O per page
+    uint32_t first = m_NextPageID;
+    m_NextPageID += count;
+    if (m_NextPageID > m_ExtentEnd) {
+        reserveExtent(m_NextPageID - 1);
+    }
+    return first;
+}
+
+void PosixFileManager::reserveExtent(uint32_t pageID)
+{
+    uint32_t extent = std::clamp(pageID / 8, MIN_EXTENT_PAGES, MAX_EXTENT_PAGES);
+    uint32_t begin = m_ExtentEnd;
+    uint32_t end = pageID + extent;
+
+    off_t offset = static_cast<off_t>(begin) * PAGE_SIZE;
+    off_t length = static_cast<off_t>(end - begin) * PAGE_SIZE;
+
+    int err = -1;
+#ifdef __linux__
+    err = ::fallocate(m_Fd, 0, offset, length);
+#endif
+    if (err != 0) {
+        // No fallocate on this filesystem / platform: a sparse extension still reads back as zeros
+        if (::ftruncate(m_Fd, offset + length) != 0) {
+            throw std::runtime_error("Failed to extend file to page " + std::to_string(end));
+        }
+    }
+
+    m_ExtentEnd = end;
+}
+
+void PosixFileManager::freePage(uint32_t pageID)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    // Guard: never free reserved pages
+    if (pageID < 2 || pageID >= m_NextPageID) {
+        return;
+    }
+
+    // Extend the map until it covers pageID, map pages come from the end of the file
+    while (!m_FreeSpaceMap.covers(pageID)) {
+        m_FreeSpaceMap.addMapPage(allocateFromExtent(1));
+    }
+
+    m_FreeSpaceMap.markFree(pageID);
+
+    // Until the map recording the free is durable a crash could bring the page back, so its
+    // blocks are only deallocated by the next flush
+    m_PendingHoles.insert(pageID);
+}
+
+void PosixFileManager::flush()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    updateMetaPage();
+    if (::fdatasync(m_Fd) != 0) {
+        throw std::runtime_error("Failed to flush file buffers");
+    }
+    punchPendingHoles();
+}
+
+void PosixFileManager::punchPendingHoles()
+{
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+    std::vector<uint32_t> pageIDs(m_PendingHoles.begin(), m_PendingHoles.end());
+    forEachRun(pageIDs, [this](uint32_t first, uint32_t count) {
+        // Best effort: without hole punching a free page just keeps its stale blocks
+        ::fallocate(m_Fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                    static_cast<off_t>(first) * PAGE_SIZE, static_cast<off_t>(count) * PAGE_SIZE);
+    });
+#endif
+    m_PendingHoles.clear();
+}
+
+bool PosixFileManager::relocateMetadataPage(uint32_t fromPageID, uint32_t toPageID)
+{
+    return m_FreeSpaceMap.relocateMapPage(fromPageID, toPageID);
+}
+
+// Free pages at the end of the file and the unused part of the preallocated extent go back to the
+// filesystem. Map pages in the way move down to the lowest free pages; a caller's page stops the scan.
+uint32_t PosixFileManager::shrink()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    uint32_t end = m_NextPageID;
+    while (end > 2) {
+        uint32_t last = end - 1;
+        if (m_FreeSpaceMap.isFree(last)) {
+            --end;
+            continue;
+        }
+
+        auto target = m_FreeSpaceMap.allocate(1, 0);
+        if (!target)
+            break;
+        if (*target > last || !relocateMetadataPage(last, *target)) {
+            m_FreeSpaceMap.markFree(*target);
+            break;
+        }
+        m_PendingHoles.erase(*target);
+        m_FreeSpaceMap.markFree(last);
+    }
+
+    m_FreeSpaceMap.truncate(end);
+    m_PendingHoles.erase(m_PendingHoles.lower_bound(end), m_PendingHoles.end());
+    m_NextPageID = end;
+
+    // Cut the file only once MetaData and the moved map pages no longer refer past the new end
+    PosixFileManager::flush();
+
+    struct stat st;
+    if (::fstat(m_Fd, &st) != 0) {
+        throw std::runtime_error("Failed to get file size");
+    }
+
+    off_t size = static_cast<off_t>(end) * PAGE_SIZE;
+    if (st.st_size <= size)
+        return 0;
+
+    if (::ftruncate(m_Fd, size) != 0) {
+        throw std::runtime_error("Failed to truncate " + m_Filename + " (" + std::strerror(errno) + ")");
+    }
+    m_ExtentEnd = end;
+
+    return static_cast<uint32_t>((st.st_size - size) / PAGE_SIZE);
+}
+
+void PosixFileManager::printFreeList()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    m_FreeSpaceMap.forEachFreeRun([](uint32_t first, uint32_t count) {
+        if (count == 1)
+            std::cout << "Free Page: " << first << "\n";
+        else
+            std::cout << "Free Pages: " << first << ".." << first + count - 1 << "\n";
+    });
+}
+
+bool PosixFileManager::pageExists(uint32_t pageID) const
+{
+    struct stat st;
+    if (::fstat(m_Fd, &st) != 0) {
+        throw std::runtime_error("Failed to get file size");
+    }
+
+    off_t pageOffset = static_cast<off_t>(pageID) * PAGE_SIZE;
+    return pageOffset + static_cast<off_t>(PAGE_SIZE) <= st.st_size;
+}
+
+void PosixFileManager::adviseAccess(uint32_t pageID, uint32_t numPages, AccessPattern pattern)
+{
+#ifdef POSIX_FADV_NORMAL
+    int advice = POSIX_FADV_NORMAL;
+    switch (pattern) {
+        case AccessPattern::SEQUENTIAL: advice = POSIX_FADV_SEQUENTIAL; break;
+        case AccessPattern::RANDOM:     advice = POSIX_FADV_RANDOM; break;
+        default: break;
+    }
+
+    // Only a hint, failures are ignored
+    ::posix_fadvise(m_Fd, static_cast<off_t>(pageID) * PAGE_SIZE,
+                    static_cast<off_t>(numPages) * PAGE_SIZE, advice);
+#endif
+}
+
+void PosixFileManager::forEachRun(std::span<const uint32_t> pageIDs, const std::function<void(uint32_t, uint32_t)>& fn)
+{
+    std::vector<uint32_t> sorted(pageIDs.begin(), pageIDs.end());
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    size_t i = 0;
+    while (i < sorted.size()) {
+        size_t j = i + 1;
+        while (j < sorted.size() && sorted[j] == sorted[i] + (j - i))
+            ++j;
+        fn(sorted[i], static_cast<uint32_t>(j - i));
+        i = j;
+    }
+}
+
+void PosixFileManager::prefetch(std::span<const uint32_t> pageIDs)
+{
+#ifdef POSIX_FADV_WILLNEED
+    // Kernel readahead into the page cache, one hint per run
+    forEachRun(pageIDs, [this](uint32_t first, uint32_t count) {
+        ::posix_fadvise(m_Fd, static_cast<off_t>(first) * PAGE_SIZE,
+                        static_cast<off_t>(count) * PAGE_SIZE, POSIX_FADV_WILLNEED);
+    });
+#endif
+}
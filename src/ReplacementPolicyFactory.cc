@@ -0,0 +1,34 @@
+#include "pebble/core/ReplacementPolicyFactory.h"
+#include "pebble/core/LruPolicy.h"
+#include "pebble/core/LruKPolicy.h"
+#include "pebble/core/TwoQPolicy.h"
+#include "pebble/core/ArcPolicy.h"
+
+#include <stdexcept>
+
+using namespace pebble::core;
+
+std::optional<ReplacementPolicyType> pebble::core::parseReplacementPolicyType(const std::string& name)
+{
+    if (name == "lru")   return ReplacementPolicyType::LRU;
+    if (name == "lru-k") return ReplacementPolicyType::LRU_K;
+    if (name == "2q")    return ReplacementPolicyType::TWO_Q;
+    if (name == "arc")   return ReplacementPolicyType::ARC;
+    return std::nullopt;
+}
+
+std::unique_ptr<IReplacementPolicy> pebble::core::createReplacementPolicy(ReplacementPolicyType type, size_t capacity)
+{
+    switch (type) {
+        case ReplacementPolicyType::LRU:
+            return std::make_unique<LruPolicy>(capacity);
+        case ReplacementPolicyType::LRU_K:
+            return std::make_unique<LruKPolicy>(capacity, 2);
+        case ReplacementPolicyType::TWO_Q:
+            return std::make_unique<TwoQPolicy>(capacity);
+        case ReplacementPolicyType::ARC:
+            return std::make_unique<ArcPolicy>(capacity);
+        default:
+            throw std::invalid_argument("Unknown replacement policy");
+    }
+}
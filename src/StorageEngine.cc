@@ -1,14 +1,23 @@
 ﻿#include "pebble/app/StorageEngine.h"
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
 
 using namespace pebble::app;
 
 StorageEngine::StorageEngine(const std::string& dbPath, size_t poolSize)
-	: m_FileManager(dbPath), 
-	m_BufferPool(m_FileManager, poolSize),
-	m_CatalogManager(m_BufferPool)
+	: StorageEngine(pebble::core::createFileManager(pebble::core::defaultFileManagerType(), dbPath), poolSize)
 {}
 
+StorageEngine::StorageEngine(std::unique_ptr<pebble::core::IFileManager> fileManager, size_t poolSize,
+	pebble::core::ReplacementPolicyType policy, size_t maxPoolSize)
+	: m_FileManager(std::move(fileManager)),
+	m_BufferPool(*m_FileManager, poolSize, policy, 0, pebble::core::HugePageMode::NONE, maxPoolSize),
+	m_CatalogManager(m_BufferPool)
+{
+	m_BufferPool.startCleaner();
+}
+
 bool StorageEngine::createCollection(const std::string& name) {
 	// Check if already loaded in memory
 	if (collections.find(name) != collections.end()) {
@@ -17,7 +26,7 @@ bool StorageEngine::createCollection(const std::string& name) {
 
 	// Ask catalog
 	auto meta = m_CatalogManager.getCollectionMeta(name);
-	if (meta) {
+	if (meta && meta->second != 0) {
 		// Already exists on disk → load it
 		auto [rootPageID, heapStartPageID] = *meta;
 
@@ -36,7 +45,10 @@ bool StorageEngine::createCollection(const std::string& name) {
 		uint32_t heapStartPageID = heap->getStartPageID();
 		uint32_t rootPageID = index->rootPageID();
 
-		m_CatalogManager.createCollection(name, rootPageID, heapStartPageID);
+		if (meta)
+			m_CatalogManager.updateCollectionMeta(name, rootPageID, heapStartPageID);	// reuse a dropped entry
+		else
+			m_CatalogManager.createCollection(name, rootPageID, heapStartPageID);
 
 		Collection coll{ std::move(heap), std::move(index) };
 		collections[name] = std::move(coll);
@@ -48,18 +60,23 @@ bool StorageEngine::createCollection(const std::string& name) {
 
 bool StorageEngine::dropCollection(const std::string& name)
 {
-	auto it = collections.find(name);
-	if (it == collections.end()) {
-		auto meta = m_CatalogManager.getCollectionMeta(name);
-		if (!meta) return false;	// Collection doesn't exist
-		// TODO: free all pages from B+Tree and HeapFile 
-	}
-	else {
-		// TODO: free in memory and on - disk pages
-		collections.erase(it);
+	auto meta = m_CatalogManager.getCollectionMeta(name);
+	if (!meta)
+		return false;	// Collection doesn't exist
+
+	if (meta->second != 0) {
+		Collection* col = loadCollection(name);
+
+		// Hand every page back, the next flush releases their disk blocks
+		for (uint32_t pageID : col->index->nodePages())
+			m_BufferPool.freePage(pageID);
+		for (uint32_t pageID : col->heap->pages())
+			m_BufferPool.freePage(pageID);
+
+		collections.erase(name);
 	}
 
-	// For now we just remove from catalog (lazy GC of pages)
+	// The catalog entry stays, zeroed
 	m_CatalogManager.updateCollectionMeta(name, 0, 0);
 	return true;
 }
@@ -140,7 +157,139 @@ void StorageEngine::printHeap(const std::string& collection)
 
 void StorageEngine::printFreeList()
 {
-	m_FileManager.printFreeList();
+	m_FileManager->printFreeList();
+}
+
+void StorageEngine::printCompressionStats()
+{
+	// Report what is on disk, including pages only modified in the pool so far
+	m_BufferPool.flushAll();
+
+	for (auto& entry : m_CatalogManager.getCollections()) {
+		if (entry.heapStartPageID == 0)
+			continue;	// dropped
+
+		Collection* col = loadCollection(entry.name);
+		if (!col)
+			continue;
+
+		auto stats = m_FileManager->compressionStats(col->heap->pages());
+		if (!stats) {
+			std::cout << "Compression not enabled for this file manager\n";
+			return;
+		}
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< entry.name << ": " << stats->compressedPages << "/" << stats->pages << " heap pages compressed, "
+			<< stats->logicalBytes << " -> " << stats->storedBytes << " bytes (ratio " << stats->ratio() << "), "
+			<< "compress " << stats->compressMBps << " MB/s, decompress " << stats->decompressMBps << " MB/s\n";
+	}
+}
+
+void StorageEngine::printBufferPoolStats() const
+{
+	auto stats = m_BufferPool.stats();
+	std::cout << std::fixed << std::setprecision(2)
+		<< "pool: " << stats.frames << " frames in use, target " << m_BufferPool.poolSize()
+		<< ", capacity " << m_BufferPool.capacity() << "\n"
+		<< "hit rate: " << stats.hitRate() * 100 << "% of " << stats.fetches << " fetches\n"
+		<< "evictions: " << stats.evictions << ", stalled on a dirty victim: " << stats.stalledEvictions
+		<< " (" << stats.stallPagesWritten << " pages written)\n"
+		<< "cleaner: " << stats.cleanerPagesWritten << " pages in " << stats.cleanerBatches << " batches, "
+		<< stats.cleanerPagesPerSecond() << " pages/s\n"
+		<< "huge pages: " << pebble::core::hugePageModeName(m_BufferPool.hugePageMode()) << "\n";
+}
+
+bool StorageEngine::resizeBufferPool(size_t frames)
+{
+	if (frames < m_BufferPool.shardCount() || frames > m_BufferPool.capacity()) {
+		std::cout << "Pool size must be between " << m_BufferPool.shardCount() << " and "
+			<< m_BufferPool.capacity() << " frames\n";
+		return false;
+	}
+
+	m_BufferPool.resize(frames);
+	std::cout << "Buffer pool resized to " << frames << " frames, " << m_BufferPool.stats().frames << " in use\n";
+	return true;
+}
+
+void StorageEngine::enableWarmRestart(const std::string& hotPagesPath)
+{
+	m_BufferPool.setWarmRestartFile(hotPagesPath);
+	auto warmup = m_BufferPool.warmUp();
+	if (warmup.pages == 0)
+		return;		// first run, nothing saved yet
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "warm restart: loaded " << warmup.loaded << " of " << warmup.pages << " hot pages in "
+		<< warmup.seconds * 1000 << " ms\n";
+}
+
+void StorageEngine::shrink()
+{
+	// Every live heap and index page, highest first, with the collection that owns it
+	struct LivePage {
+		uint32_t pageID;
+		Collection* col;
+		bool heap;
+	};
+	std::vector<LivePage> live;
+	std::vector<std::pair<std::string, Collection*>> owners;
+
+	for (auto& entry : m_CatalogManager.getCollections()) {
+		if (entry.heapStartPageID == 0)
+			continue;	// dropped
+
+		Collection* col = loadCollection(entry.name);
+		if (!col)
+			continue;
+
+		owners.emplace_back(entry.name, col);
+		for (uint32_t pageID : col->heap->pages())
+			live.push_back({ pageID, col, true });
+		for (uint32_t pageID : col->index->nodePages())
+			live.push_back({ pageID, col, false });
+	}
+	std::sort(live.begin(), live.end(), [](const LivePage& a, const LivePage& b) { return a.pageID > b.pageID; });
+
+	// Move pages from the tail into the lowest free pages until no free page is left below them
+	std::unordered_map<Collection*, std::unordered_map<uint32_t, uint32_t>> heapMoves;
+	std::unordered_map<Collection*, std::unordered_map<uint32_t, uint32_t>> indexMoves;
+	size_t moved = 0;
+
+	for (const LivePage& page : live) {
+		uint32_t target = m_BufferPool.allocatePage();
+		if (target > page.pageID) {
+			m_BufferPool.freePage(target);
+			break;
+		}
+
+		m_BufferPool.movePage(page.pageID, target);
+		(page.heap ? heapMoves : indexMoves)[page.col][page.pageID] = target;
+		++moved;
+	}
+
+	// Fix the references: heap chains, tree pointers, record IDs in the leaves, catalog entries
+	for (auto& [name, col] : owners) {
+		auto& heapMoved = heapMoves[col];
+		auto& indexMoved = indexMoves[col];
+		if (heapMoved.empty() && indexMoved.empty())
+			continue;
+
+		pebble::core::HeapFile& heap = *col->heap;
+		heap.relocate(heapMoved);
+		col->index->relocate(indexMoved, [&](uint64_t recordID) { return heap.relocateRecordID(recordID, heapMoved); });
+
+		m_CatalogManager.updateCollectionMeta(name, col->index->rootPageID(), heap.getStartPageID());
+	}
+
+	// Everything must point at the new pages on disk before the file is cut
+	m_CatalogManager.flush();
+	m_BufferPool.flushAll();
+
+	uint32_t released = m_FileManager->shrink();
+	std::cout << "Moved " << moved << " pages, released " << released << " pages ("
+		<< (static_cast<uint64_t>(released) * pebble::core::PAGE_SIZE >> 10) << " KiB)\n";
 }
 
 StorageEngine::Collection* StorageEngine::loadCollection(const std::string& name)
@@ -156,6 +305,8 @@ StorageEngine::Collection* StorageEngine::loadCollection(const std::string& name
 		return nullptr;
 
 	auto &[rootPage, heapPage] = *metaOpt;
+	if (heapPage == 0)
+		return nullptr;	// dropped
 
 	Collection col;
 	col.index = std::make_unique<pebble::core::BPlusTree>(m_BufferPool, rootPage);
@@ -0,0 +1,82 @@
+#include "pebble/core/TwoQPolicy.h"
+
+#include <algorithm>
+
+using namespace pebble::core;
+
+TwoQPolicy::TwoQPolicy(size_t capacity)
+    : m_InTarget(std::max<size_t>(1, capacity / 4)),
+      m_OutMax(std::max<size_t>(1, capacity / 2)),
+      m_Links(capacity),
+      m_Queue(capacity, Queue::NONE),
+      m_PageIDs(capacity, 0)
+{}
+
+void TwoQPolicy::unlink(uint32_t frame)
+{
+    switch (m_Queue[frame]) {
+        case Queue::IN:   m_Links.remove(m_In, frame); break;
+        case Queue::MAIN: m_Links.remove(m_Main, frame); break;
+        default: return;
+    }
+    m_Queue[frame] = Queue::NONE;
+}
+
+void TwoQPolicy::recordHit(uint32_t frame)
+{
+    // Hits in A1in are treated as correlated with the first reference and do not promote
+    if (m_Queue[frame] == Queue::MAIN)
+        m_Links.moveToFront(m_Main, frame);
+}
+
+void TwoQPolicy::recordLoad(uint32_t frame, uint32_t pageID)
+{
+    unlink(frame);
+    m_PageIDs[frame] = pageID;
+
+    // Re-referenced after leaving A1in: a hot page
+    auto ghost = m_OutPos.find(pageID);
+    if (ghost != m_OutPos.end()) {
+        m_Out.erase(ghost->second);
+        m_OutPos.erase(ghost);
+        m_Links.pushFront(m_Main, frame);
+        m_Queue[frame] = Queue::MAIN;
+        return;
+    }
+
+    m_Links.pushFront(m_In, frame);
+    m_Queue[frame] = Queue::IN;
+}
+
+void TwoQPolicy::recordEvict(uint32_t frame)
+{
+    Queue queue = m_Queue[frame];
+    unlink(frame);
+    if (queue != Queue::IN)
+        return;
+
+    uint32_t pageID = m_PageIDs[frame];
+    m_Out.push_front(pageID);
+    m_OutPos[pageID] = m_Out.begin();
+
+    while (m_Out.size() > m_OutMax) {
+        m_OutPos.erase(m_Out.back());
+        m_Out.pop_back();
+    }
+}
+
+void TwoQPolicy::forget(uint32_t frame)
+{
+    unlink(frame);
+}
+
+void TwoQPolicy::forEachVictim(const std::function<bool(uint32_t frame)>& fn) const
+{
+    // Reclaim from A1in while it is over target, otherwise from the cold end of Am
+    bool fromIn = m_In.size > m_InTarget;
+    const FrameLinks::List& first = fromIn ? m_In : m_Main;
+    const FrameLinks::List& second = fromIn ? m_Main : m_In;
+
+    if (m_Links.forEachFromTail(first, fn))
+        m_Links.forEachFromTail(second, fn);
+}
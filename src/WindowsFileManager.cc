@@ -31,6 +31,11 @@ WindowsFileManager::WindowsFileManager(const std::string& filename)
 WindowsFileManager::~WindowsFileManager() 
 {
     if(m_FileHandle != INVALID_HANDLE_VALUE) {
+        try {
+            updateMetaPage();
+        } catch (const std::exception& e) {
+            std::cerr << "WindowsFileManager: " << e.what() << "\n";
+        }
         FlushFileBuffers(m_FileHandle);
         CloseHandle(m_FileHandle);
     }
@@ -54,6 +59,7 @@ void WindowsFileManager::loadMetaPage()
     }
     else
     {
+        meta.checkCompatible(m_Filename);
         this->m_NextPageID = meta.m_NextPageID;
         this->m_FreeListHead = meta.m_FreeListHead;
     }
@@ -92,6 +98,7 @@ void WindowsFileManager::readPage(uint32_t pageID, Page& page) {
                                  " (read " + std::to_string(bytesRead) + " bytes)");
     }
 
+    verifyChecksum(pageID, page);
     page.setPageID(pageID);
 }
 
@@ -110,6 +117,8 @@ void WindowsFileManager::writePage(const Page& page) {
         throw std::runtime_error("Failed to seek to page " + std::to_string(page.getPageID()));
     }
 
+    page.stampChecksum();
+
     DWORD bytesWritten = 0;
     BOOL result = WriteFile(m_FileHandle, page.data(), PAGE_SIZE, &bytesWritten, nullptr);
     if (!result || bytesWritten != PAGE_SIZE) {
@@ -149,10 +158,28 @@ uint32_t WindowsFileManager::allocatePage()
     blank.setPageID(pageID);
     writePage(blank);
 
-    updateMetaPage();
+    // MetaData is persisted by flush()
     return pageID;
 }
 
+uint32_t WindowsFileManager::allocatePages(uint32_t count, uint32_t nearPageID)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_RecMutex);
+
+    if (count == 1)
+        return allocatePage();
+
+    // The freelist is not ordered, so multi-page runs always come from the end of the file
+    uint32_t first = m_NextPageID;
+    m_NextPageID += count;
+
+    for (uint32_t pageID = first; pageID < first + count; ++pageID) {
+        Page blank;
+        blank.setPageID(pageID);
+        writePage(blank);
+    }
+    return first;
+}
 
 void WindowsFileManager::freePage(uint32_t pageID)
 {
@@ -175,13 +202,13 @@ void WindowsFileManager::freePage(uint32_t pageID)
     writePage(page);
 
     m_FreeListHead = pageID;
-    updateMetaPage();
 }
 
 void WindowsFileManager::flush() 
 {
     std::lock_guard<std::recursive_mutex> lock(m_RecMutex);    
 
+    updateMetaPage();
     if (!FlushFileBuffers(m_FileHandle)) {
         throw std::runtime_error("Failed to flush file buffers");
     }
@@ -1,10 +1,13 @@
 #include "pebble/app/StorageEngine.h"
 #include "pebble/app/CLI.h"
+#include <cstdlib>
 #include <iostream>
 
 using namespace pebble::app;
 
-int main() {
+constexpr size_t DEFAULT_MAX_POOL_FRAMES = 4096;
+
+int main(int argc, char** argv) {
     /*StorageEngine engine("kvstore.db", 10);
     const std::string collectionName = "users";
 
@@ -33,7 +36,47 @@ int main() {
         }
     }*/
 
-    pebble::app::StorageEngine engine("kvstore.db", 10);
+    // Usage: pebble-db [dbPath] [posix|windows|io_uring|mmap|direct|compressed] [lru|lru-k|2q|arc]
+    //                  [poolFrames] [maxPoolFrames]
+    std::string dbPath = argc > 1 ? argv[1] : "kvstore.db";
+    auto backend = pebble::core::defaultFileManagerType();
+    if (argc > 2) {
+        auto parsed = pebble::core::parseFileManagerType(argv[2]);
+        if (!parsed) {
+            std::cerr << "Unknown file manager backend: " << argv[2] << "\n";
+            return 1;
+        }
+        backend = *parsed;
+    }
+    auto policy = pebble::core::ReplacementPolicyType::LRU;
+    if (argc > 3) {
+        auto parsed = pebble::core::parseReplacementPolicyType(argv[3]);
+        if (!parsed) {
+            std::cerr << "Unknown replacement policy: " << argv[3] << "\n";
+            return 1;
+        }
+        policy = *parsed;
+    }
+
+    // The pool can be resized up to maxPoolFrames while running, frames take memory once used
+    size_t poolFrames = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 10;
+    size_t maxPoolFrames = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : DEFAULT_MAX_POOL_FRAMES;
+    if (poolFrames == 0) {
+        std::cerr << "Invalid pool size: " << argv[4] << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<pebble::core::IFileManager> fileManager;
+    try {
+        fileManager = pebble::core::createFileManager(backend, dbPath);
+    } catch (const std::exception& e) {
+        // e.g. a file created by a build with a different PEBBLE_PAGE_SIZE
+        std::cerr << "Cannot open " << dbPath << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    pebble::app::StorageEngine engine(std::move(fileManager), poolFrames, policy, maxPoolFrames);
+    engine.enableWarmRestart(dbPath + ".hot");
     CLI cli(engine);
     cli.run();
 